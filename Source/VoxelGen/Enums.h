@@ -11,7 +11,7 @@ enum class EDirection
 };
 
 UENUM()
-enum class EBlock
+enum class EBlock : uint8
 {
 	Air UMETA(DisplayName = "Air"),
 	Grass UMETA(DisplayName = "Grass"),
@@ -30,6 +30,8 @@ enum class EBlock
 	GrassFoliage UMETA(DisplayName = "Grass Foliage")
 };
 
+constexpr int32 BlockTypeCount = static_cast<int32>(EBlock::GrassFoliage) + 1;
+
 UENUM(BlueprintType)
 enum class EFoliageType : uint8
 {
@@ -39,6 +41,16 @@ enum class EFoliageType : uint8
 	GrassPlant UMETA(DisplayName = "Grass Plant") 
 };
 
+// How trees and cacti pick the columns they grow on
+UENUM()
+enum class EFoliagePlacement : uint8
+{
+	// Every column rolls every rule of its biome
+	PerColumn UMETA(DisplayName = "Per Column"),
+	// One candidate column per world grid cell, jittered by a hash of the cell; only candidates roll
+	JitteredGrid UMETA(DisplayName = "Jittered Grid")
+};
+
 UENUM()
 enum class EBlockMaterialType
 {
@@ -117,6 +129,8 @@ enum class EBiomeType : uint8
 	Ice					UMETA(DisplayName = "Ice")
 };
 
+constexpr int32 BiomeTypeCount = static_cast<int32>(EBiomeType::Ice) + 1;
+
 static FName BiomeTypeToFName(EBiomeType BiomeType)
 {
 	return FName(UEnum::GetValueAsString(BiomeType).RightChop(12)); // Removes "EBiomeType::"
@@ -4,6 +4,7 @@
 #include "Actors/ChunkBase.h"
 
 #include "ProceduralMeshComponent.h"
+#include "Components/InstancedStaticMeshComponent.h"
 #include "Actors/ChunkWorld.h"
 #include "Structs/ChunkData.h"
 #include "Objects/ChunkMeshLoaderAsync.h"
@@ -38,7 +39,7 @@ void AChunkBase::BeginPlay()
 			FVector(0,0,0)
 	};
 
-	ChunkColumns.SetNum(FChunkData::GetChunkSize(this) * FChunkData::GetChunkSize(this));
+	Voxels.Initialize(FChunkData::GetChunkSize(this), FChunkData::GetChunkHeight(this));
     CacheBlockDataTable();
 }
 
@@ -95,11 +96,101 @@ void AChunkBase::ApplyMesh()
 		Mesh->SetMaterial(3, GrassMaterial);
 	}
 
-	bCanChangeBlocks = true;
-	bIsProcessingMesh = false;
+	ApplyCrossPlaneInstances();
+
 	bIsMeshInitialized = true;
 }
 
+void AChunkBase::ApplyCrossPlaneInstances()
+{
+	// Types that lost all their blocks keep their component, emptied
+	for (const TPair<EBlock, TObjectPtr<UInstancedStaticMeshComponent>>& Pair : CrossPlaneComponents)
+	{
+		if (Pair.Value && !CrossPlaneInstanceData.Contains(Pair.Key))
+		{
+			Pair.Value->ClearInstances();
+		}
+	}
+
+	CrossPlaneInstances = MoveTemp(CrossPlaneInstanceData);
+	CrossPlaneInstanceData.Reset();
+
+	for (TPair<EBlock, FCrossPlaneInstances>& Pair : CrossPlaneInstances)
+	{
+		FCrossPlaneInstances& Instances = Pair.Value;
+		UInstancedStaticMeshComponent* Component = GetCrossPlaneComponent(Pair.Key);
+		if (!Component) continue;
+
+		Component->ClearInstances();
+		Component->AddInstances(Instances.Transforms, false, false, false);
+		for (int32 i = 0; i < Instances.Variants.Num(); ++i)
+		{
+			Component->SetCustomDataValue(i, 0, Instances.Variants[i]);
+		}
+		Component->MarkRenderStateDirty();
+
+		Instances.IndexByPosition.Reset();
+		Instances.IndexByPosition.Reserve(Instances.Positions.Num());
+		for (int32 i = 0; i < Instances.Positions.Num(); ++i)
+		{
+			Instances.IndexByPosition.Add(Instances.Positions[i], i);
+		}
+
+		// The component owns the transforms now
+		Instances.Transforms.Empty();
+		Instances.Variants.Empty();
+	}
+}
+
+UInstancedStaticMeshComponent* AChunkBase::GetCrossPlaneComponent(EBlock BlockType)
+{
+	if (const TObjectPtr<UInstancedStaticMeshComponent>* Found = CrossPlaneComponents.Find(BlockType))
+	{
+		return *Found;
+	}
+
+	const FBlockSettings Settings = GetBlockData(BlockType);
+	if (!Settings.InstanceMesh) return nullptr;
+
+	UInstancedStaticMeshComponent* Component = NewObject<UInstancedStaticMeshComponent>(this);
+	Component->SetStaticMesh(Settings.InstanceMesh);
+	Component->SetNumCustomDataFloats(1);
+	Component->SetCastShadow(false);
+	Component->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	Component->SetupAttachment(Mesh);
+	Component->RegisterComponent();
+
+	CrossPlaneComponents.Add(BlockType, Component);
+	return Component;
+}
+
+bool AChunkBase::RemoveCrossPlaneInstance(const FIntVector& Position, EBlock BlockType)
+{
+	FCrossPlaneInstances* Instances = CrossPlaneInstances.Find(BlockType);
+	UInstancedStaticMeshComponent* Component = CrossPlaneComponents.FindRef(BlockType);
+	if (!Instances || !Component) return false;
+
+	int32 Index;
+	if (!Instances->IndexByPosition.RemoveAndCopyValue(Position, Index)) return false;
+
+	// The last instance moves into the hole, so removing from the end shifts nothing else
+	const int32 LastIndex = Instances->Positions.Num() - 1;
+	if (Index != LastIndex)
+	{
+		FTransform LastTransform;
+		Component->GetInstanceTransform(LastIndex, LastTransform, false);
+		Component->UpdateInstanceTransform(Index, LastTransform, false, false, true);
+		Component->SetCustomDataValue(Index, 0, Component->PerInstanceSMCustomData[LastIndex * Component->NumCustomDataFloats], false);
+
+		Instances->Positions[Index] = Instances->Positions[LastIndex];
+		Instances->IndexByPosition[Instances->Positions[Index]] = Index;
+	}
+
+	Component->RemoveInstance(LastIndex);
+	Instances->Positions.Pop(EAllowShrinking::No);
+	return true;
+}
+
 FIntVector AChunkBase::GetPositionInDirection(EDirection Direction, const FIntVector& Position) const
 {
 	FVector Pos(Position);
@@ -149,6 +240,8 @@ void AChunkBase::CreateCrossPlanes(const FIntVector& BlockPos, EBlock BlockType,
     FVector C( HalfWidth,  0,    0);
     FVector D(-HalfWidth,  0,    0);
 
+	FTransform Transform;
+
 	// Randomize rotation
 	if (Settings.RandomRotation)
 	{
@@ -159,6 +252,25 @@ void AChunkBase::CreateCrossPlanes(const FIntVector& BlockPos, EBlock BlockType,
 		B = Rot.RotateVector(B);
 		C = Rot.RotateVector(C);
 		D = Rot.RotateVector(D);
+
+		if (Settings.InstanceMesh)
+		{
+			Transform.SetRotation(Rot);
+		}
+	}
+
+	// Instanced blocks only record a transform; sized like the planes below, which are half RenderHeight tall
+	if (Settings.InstanceMesh)
+	{
+		const float BlockScale = FChunkData::GetBlockScale(this);
+		Transform.SetLocation(Origin);
+		Transform.SetScale3D(FVector(Settings.RenderScale, Settings.RenderScale, Settings.RenderHeight * 0.5f) * BlockScale);
+
+		FCrossPlaneInstances& Instances = CrossPlaneInstanceData.FindOrAdd(BlockType);
+		Instances.Transforms.Add(Transform);
+		Instances.Variants.Add(static_cast<float>(VariantIndex));
+		Instances.Positions.Add(BlockPos);
+		return;
 	}
 
     // Two quads, rotated 90° around Z
@@ -250,6 +362,22 @@ bool AChunkBase::ShouldRenderFace(int X, int Y, int Z) const
 	return GetBlockAtPosition(FIntVector(X, Y, Z)) == EBlock::Air;
 }
 
+FChunkSection AChunkBase::GetSectionAt(int32 SectionIndex, const FIntVector2& ChunkOffset) const
+{
+	if (SectionIndex < 0 || SectionIndex >= Voxels.NumSections()) return FChunkSection();
+	if (ChunkOffset == FIntVector2(0, 0)) return Voxels.GetSection(SectionIndex);
+
+	if (!ParentWorld) return FChunkSection();
+	if (const AChunkBase* AdjChunk = ParentWorld->GetChunksData().FindRef(ChunkPosition + ChunkOffset))
+	{
+		if (SectionIndex < AdjChunk->Voxels.NumSections())
+		{
+			return AdjChunk->Voxels.GetSection(SectionIndex);
+		}
+	}
+	return FChunkSection();
+}
+
 void AChunkBase::RegenerateMesh()
 {
 	// Clear all mesh data stores
@@ -263,30 +391,100 @@ void AChunkBase::RegenerateMesh()
 	LeavesVertexCount = 0;
 	GrassVertexCount = 0;
 
+	CrossPlaneInstanceData.Reset();
+
 	GenerateMesh();
 	AsyncTask(ENamedThreads::GameThread, [&]()
 	{
 		ApplyMesh();
-		ParentWorld->NotifyMeshTaskCompleted();
+		ParentWorld->NotifyMeshTaskCompleted(this);
+
+		// Voxels changed while the task ran
+		if (bRemeshRequested)
+		{
+			bRemeshRequested = false;
+			RegenerateMeshAsync();
+		}
 	});
 }
 
 void AChunkBase::RegenerateMeshAsync()
 {
+	if (bIsProcessingMesh)
+	{
+		bRemeshRequested = true;
+		return;
+	}
+
+	bIsProcessingMesh = true;
+	ParentWorld->NotifyMeshTaskStarted();
 	(new FAutoDeleteAsyncTask<FChunkMeshLoaderAsync>(this))->StartBackgroundTask();
 }
 
+bool AChunkBase::CanWriteVoxels() const
+{
+	if (bIsProcessingMesh) return false;
+	if (!ParentWorld) return true;
+
+	static const FIntVector2 SideOffsets[] = { {1, 0}, {-1, 0}, {0, 1}, {0, -1} };
+	for (const FIntVector2& Offset : SideOffsets)
+	{
+		const AChunkBase* AdjChunk = ParentWorld->GetChunksData().FindRef(ChunkPosition + Offset);
+		if (AdjChunk && AdjChunk->bIsProcessingMesh) return false;
+	}
+	return true;
+}
+
+bool AChunkBase::ApplyDeferredBlockChanges()
+{
+	if (!CanWriteVoxels()) return false;
+
+	bool bNeedsRemesh = false;
+	for (const FDeferredBlockChange& Change : DeferredBlockChanges)
+	{
+		const bool bChanged = Change.bDestroy ? WriteDestroyedBlock(Change.Position) : WriteSpawnedBlock(Change.Position, Change.Block);
+		bNeedsRemesh = bNeedsRemesh || bChanged;
+	}
+	DeferredBlockChanges.Reset();
+
+	UpdateAdjacentChunks();
+	if (bNeedsRemesh)
+	{
+		RegenerateMeshAsync();
+	}
+	return true;
+}
+
+void AChunkBase::DeferBlockChange(const FIntVector& LocalChunkBlockPosition, EBlock BlockType, bool bDestroy)
+{
+	DeferredBlockChanges.Add({ LocalChunkBlockPosition, BlockType, bDestroy });
+	ParentWorld->QueueDeferredBlockChanges(ChunkPosition);
+}
+
 void AChunkBase::ClearMesh()
 {
 	if (!Mesh) return;
 	
 	Mesh->ClearAllMeshSections();
+	for (const TPair<EBlock, TObjectPtr<UInstancedStaticMeshComponent>>& Pair : CrossPlaneComponents)
+	{
+		if (Pair.Value)
+		{
+			Pair.Value->ClearInstances();
+		}
+	}
+	CrossPlaneInstances.Reset();
 	bIsMeshInitialized = false;
 }
 
-void AChunkBase::SetColumns(const TArray<FChunkColumn>& NewColumns)
+void AChunkBase::SetVoxels(const FChunkVoxels& NewVoxels)
 {
-	ChunkColumns = NewColumns;
+	Voxels = NewVoxels;
+}
+
+void AChunkBase::SetVoxels(FChunkVoxels&& NewVoxels)
+{
+	Voxels = MoveTemp(NewVoxels);
 }
 
 EBlock AChunkBase::GetBlockAtPosition(const FIntVector& Position) const
@@ -300,14 +498,12 @@ EBlock AChunkBase::GetBlockAtPosition(const FIntVector& Position) const
         Position.Y >= 0 && Position.Y < ChunkSize &&
         Position.Z >= 0 && Position.Z < ChunkHeight)
     {
-        const int32 ColumnIndex = Position.X + (Position.Y * ChunkSize);
-        
-        if (ColumnIndex >= 0 && ColumnIndex < ChunkColumns.Num())
+        if (Voxels.IsInside(Position.X, Position.Y, Position.Z))
         {
-            return ChunkColumns[ColumnIndex].Blocks[Position.Z];
+            return Voxels.GetBlock(Position.X, Position.Y, Position.Z);
         }
         
-        UE_LOG(LogTemp, Warning, TEXT("Invalid column index: %d"), ColumnIndex);
+        UE_LOG(LogTemp, Warning, TEXT("Invalid voxel position: %s"), *Position.ToString());
         return EBlock::Air;
     }
     
@@ -344,10 +540,9 @@ EBlock AChunkBase::GetBlockAtPosition(const FIntVector& Position) const
     	if (!ParentWorld) return EBlock::Air;
         if (AChunkBase* AdjChunk = ParentWorld->GetChunksData().FindRef(AdjChunkPos))
         {
-            const int32 AdjColumnIndex = LocalPos.X + (LocalPos.Y * ChunkSize);
-            if (AdjColumnIndex >= 0 && AdjColumnIndex < AdjChunk->ChunkColumns.Num())
+            if (AdjChunk->Voxels.IsInside(LocalPos.X, LocalPos.Y, LocalPos.Z))
             {
-                return AdjChunk->ChunkColumns[AdjColumnIndex].Blocks[LocalPos.Z];
+                return AdjChunk->Voxels.GetBlock(LocalPos.X, LocalPos.Y, LocalPos.Z);
             }
         }
     }
@@ -383,13 +578,14 @@ void AChunkBase::SetBlockAtPosition(const FIntVector& Position, EBlock BlockType
 {
 	if (IsWithinChunkBounds(Position))
 	{
-		ChunkColumns[FChunkData::GetColumnIndex(this, Position.X, Position.Y)].Blocks[Position.Z] = BlockType;
+		Voxels.SetBlock(Position.X, Position.Y, Position.Z, BlockType);
+		Edits.Record(Voxels.GetBlockIndex(Position.X, Position.Y, Position.Z), BlockType);
 
 		if (!bIsMeshInitialized) return;
 		// Update the adjacent chunk only when destroying block to prevent updating the whole chunk mesh when spawning a block
 		if (BlockType == EBlock::Air || BlockType == EBlock::Water)
 		{
-			UpdateAdjacentChunk(Position);
+			ChangedEdgeBlocks.Add(Position);
 		}
 	}
 	else
@@ -414,6 +610,15 @@ void AChunkBase::UpdateAdjacentChunk(const FIntVector& LocalEdgeBlockPosition) c
 	}
 }
 
+void AChunkBase::UpdateAdjacentChunks()
+{
+	for (const FIntVector& Position : ChangedEdgeBlocks)
+	{
+		UpdateAdjacentChunk(Position);
+	}
+	ChangedEdgeBlocks.Reset();
+}
+
 TArray<FIntVector> AChunkBase::GetEdgeOffsets(const FIntVector& LocalEdgeBlockPosition) const
 {
 	TArray<FIntVector> Offsets;
@@ -476,33 +681,71 @@ bool AChunkBase::IsWithinVerticalBounds(const FIntVector& Position) const
 
 void AChunkBase::SpawnBlock(const FIntVector& LocalChunkBlockPosition, EBlock BlockType)
 {
- 	if (!bCanChangeBlocks) return;
-
-	EBlock CurrentBlockType = GetBlockAtPosition(LocalChunkBlockPosition);
-	if (CurrentBlockType != EBlock::Air && CurrentBlockType != EBlock::Water) return;
+	// Blocks past the sides belong to the neighbour, which defers them itself
+	if (!IsWithinChunkBounds(LocalChunkBlockPosition))
+	{
+		SetBlockAtPosition(LocalChunkBlockPosition, BlockType);
+		return;
+	}
 
-	bCanChangeBlocks = false;
-	SetBlockAtPosition(LocalChunkBlockPosition, BlockType);
+	if (!CanWriteVoxels())
+	{
+		DeferBlockChange(LocalChunkBlockPosition, BlockType, false);
+		return;
+	}
 
-	if (IsWithinChunkBounds(LocalChunkBlockPosition))
+	if (WriteSpawnedBlock(LocalChunkBlockPosition, BlockType))
 	{
+		UpdateAdjacentChunks();
 		RegenerateMeshAsync();
 	}
 }
 
 void AChunkBase::DestroyBlock(const FIntVector& LocalChunkBlockPosition)
 {
-	if (!bCanChangeBlocks) return;
-
 	if (!IsWithinChunkBounds(LocalChunkBlockPosition)) return;
 
-	bCanChangeBlocks = false;
-	
-	if (GetBlockAtPosition(GetPositionInDirection(EDirection::Up, LocalChunkBlockPosition)) == EBlock::Water
+	if (!CanWriteVoxels())
+	{
+		DeferBlockChange(LocalChunkBlockPosition, EBlock::Air, true);
+		return;
+	}
+
+	const bool bNeedsRemesh = WriteDestroyedBlock(LocalChunkBlockPosition);
+	UpdateAdjacentChunks();
+	if (bNeedsRemesh)
+	{
+		RegenerateMeshAsync();
+	}
+}
+
+bool AChunkBase::WriteSpawnedBlock(const FIntVector& LocalChunkBlockPosition, EBlock BlockType)
+{
+	EBlock CurrentBlockType = GetBlockAtPosition(LocalChunkBlockPosition);
+	if (CurrentBlockType != EBlock::Air && CurrentBlockType != EBlock::Water) return false;
+
+	SetBlockAtPosition(LocalChunkBlockPosition, BlockType);
+	return true;
+}
+
+bool AChunkBase::WriteDestroyedBlock(const FIntVector& LocalChunkBlockPosition)
+{
+	const bool bFloods = GetBlockAtPosition(GetPositionInDirection(EDirection::Up, LocalChunkBlockPosition)) == EBlock::Water
 		|| GetBlockAtPosition(GetPositionInDirection(EDirection::Left, LocalChunkBlockPosition)) == EBlock::Water
 		|| GetBlockAtPosition(GetPositionInDirection(EDirection::Right, LocalChunkBlockPosition)) == EBlock::Water
 		|| GetBlockAtPosition(GetPositionInDirection(EDirection::Forward, LocalChunkBlockPosition)) == EBlock::Water
-		|| GetBlockAtPosition(GetPositionInDirection(EDirection::Backward, LocalChunkBlockPosition)) == EBlock::Water)
+		|| GetBlockAtPosition(GetPositionInDirection(EDirection::Backward, LocalChunkBlockPosition)) == EBlock::Water;
+
+	// An instanced cross-plane block hides no faces, so dropping its instance is the whole update
+	const EBlock DestroyedBlock = GetBlockAtPosition(LocalChunkBlockPosition);
+	if (!bFloods && bIsMeshInitialized && RemoveCrossPlaneInstance(LocalChunkBlockPosition, DestroyedBlock))
+	{
+		Voxels.SetBlock(LocalChunkBlockPosition.X, LocalChunkBlockPosition.Y, LocalChunkBlockPosition.Z, EBlock::Air);
+		Edits.Record(Voxels.GetBlockIndex(LocalChunkBlockPosition.X, LocalChunkBlockPosition.Y, LocalChunkBlockPosition.Z), EBlock::Air);
+		return false;
+	}
+
+	if (bFloods)
 	{
 		SetBlockAtPosition(LocalChunkBlockPosition, EBlock::Water);
 	}
@@ -517,8 +760,8 @@ void AChunkBase::DestroyBlock(const FIntVector& LocalChunkBlockPosition)
 			SetBlockAtPosition(UpBlockPos, EBlock::Air);
 		}
 	}
-	
-	RegenerateMeshAsync();
+
+	return true;
 }
 
 FChunkMeshData& AChunkBase::GetMeshDataForBlock(EBlock BlockType)
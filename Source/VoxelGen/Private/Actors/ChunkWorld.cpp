@@ -1,13 +1,18 @@
-#include "Actors/ChunkWorld.h"
+﻿#include "Actors/ChunkWorld.h"
 
 #include "Actors/ChunkBase.h"
 #include "Kismet/GameplayStatics.h"
+#include "Objects/ChunkGenerationAsync.h"
+#include "Objects/ChunkRegionStore.h"
 #include "Objects/TerrainGenerator.h"
 #include "Structs/ChunkData.h"
+#include "Structs/TerrainGenerationStats.h"
 #include "Player/Character/VoxelGenerationCharacter.h"
 #include "HAL/PlatformMisc.h"
 #include "Async/Async.h"
 #include "Logging/LogMacros.h"
+#include "Misc/Paths.h"
+#include "Tasks/Task.h"
 
 
 float DistSquared(const FIntVector2& A, const FIntVector2& B)
@@ -34,6 +39,13 @@ void AChunkWorld::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
     Super::EndPlay(EndPlayReason);
 
+    LogSavedChunkStats();
+    PersistWorld();
+
+    // Results of generation tasks still in flight are dropped from here on
+    bWorldInitialized = false;
+    ++GenerationId;
+
     TArray<FIntVector2> Keys;
     ChunksData.GetKeys(Keys);
     for (const FIntVector2& Key : Keys)
@@ -43,7 +55,19 @@ void AChunkWorld::EndPlay(const EEndPlayReason::Type EndPlayReason)
 
     ChunksData.Empty();
     ChunksPendingGenerationMap.Empty();
+    ChunkDataGenerationQueue.Empty();
+    ChunksGeneratingData.Empty();
     VisibleChunks.Empty();
+    ChunksWithDeferredBlockChanges.Empty();
+    ClearSavedChunks();
+    ChunksReadingRecords.Empty();
+
+    // The only place the game thread waits for the files, so the session's edits are on disk before it exits
+    if (RegionStore)
+    {
+        RegionStore->Flush();
+        RegionStore.Reset();
+    }
 
     RunningMeshTasks = 0;
 }
@@ -55,6 +79,8 @@ void AChunkWorld::InitializeWorld()
     Seed = FChunkData::GetSeed(this);
     ChunkSize = FChunkData::GetChunkSize(this);
     ScaledBlockSize = FChunkData::GetScaledBlockSize(this);
+
+    OpenRegionStore();
     
     PlayerCharacter = Cast<AVoxelGenerationCharacter>(UGameplayStatics::GetPlayerCharacter(GetWorld(), 0));
     if (!PlayerCharacter) return;
@@ -81,23 +107,48 @@ void AChunkWorld::Tick(float DeltaTime)
     if (IsPlayerChunkUpdated())
     {
         UpdateChunksData();
+        ForgetDistantChunks();
         UpdateChunksForGeneration();
         SortVisibleChunksByDistance();
     }
+    else if (bVisibleChunksDirty)
+    {
+        // Newly generated chunks arrived since the last update
+        UpdateChunksForGeneration();
+        SortVisibleChunksByDistance();
+    }
+    bVisibleChunksDirty = false;
+
+    ProcessChunksDataGeneration();
+    FlushDeferredBlockChanges();
     ProcessChunksMeshGeneration();
 }
 
 void AChunkWorld::RegenerateWorld()
 {
-    for (const auto& Pair : ChunksData)
+    // Every modified chunk is queued for writing here, so destroying them below must not save them again
+    PersistWorld();
+    const bool bWasInitialized = bWorldInitialized;
+    bWorldInitialized = false;
+
+    // DestroyChunkActor removes from ChunksData
+    TArray<FIntVector2> Keys;
+    ChunksData.GetKeys(Keys);
+    for (const FIntVector2& Key : Keys)
     {
-        DestroyChunkActor(Pair.Key);
+        DestroyChunkActor(Key);
     }
-    
+    bWorldInitialized = bWasInitialized;
+
     ChunksData.Empty();
-    SavedChunkColumns.Empty();
+    ClearSavedChunks();
     ChunksPendingGenerationMap.Empty();
+    ChunkDataGenerationQueue.Empty();
+    ChunksGeneratingData.Empty();
     VisibleChunks.Empty();
+    ChunksWithDeferredBlockChanges.Empty();
+    ChunksReadingRecords.Empty();
+    ++GenerationId;
 
     Seed = FChunkData::GetSeed(this);
     ChunkSize = FChunkData::GetChunkSize(this);
@@ -107,10 +158,12 @@ void AChunkWorld::RegenerateWorld()
     {
         TerrainGenerator->UpdateSeed(Seed);
     }
+    OpenRegionStore();
     
     UpdateChunksData();
     UpdateChunksForGeneration();
     SortVisibleChunksByDistance();
+    ProcessChunksDataGeneration();
     ProcessChunksMeshGeneration();
 }
 
@@ -222,15 +275,21 @@ void AChunkWorld::UpdateChunksData()
          }
      }
 
-     // 3. Identify Chunks to Add (required but not currently loaded)
+     // 3. Identify Chunks to Add (required but neither loaded nor already being generated)
      for (const FIntVector2& RequiredCoord : RequiredChunks)
      {
-         if (!ChunksData.Contains(RequiredCoord))
+         if (!ChunksData.Contains(RequiredCoord) && !IsChunkDataPending(RequiredCoord))
          {
              ChunksToAdd.Add(RequiredCoord);
          }
      }
 
+     // Queued chunks that are no longer required never need to be generated
+     ChunkDataGenerationQueue.RemoveAll([&RequiredChunks](const FIntVector2& Coord)
+     {
+         return !RequiredChunks.Contains(Coord);
+     });
+
      // 4. Destroy Chunks that are out of LoadDistance
      for (const FIntVector2& CoordToRemove : ChunksToRemove)
      {
@@ -249,6 +308,11 @@ void AChunkWorld::UpdateChunksData()
              LoadChunkAtPosition(CoordToAdd);
          }
      }
+
+     // Keep the generation queue nearest-first relative to the new player chunk
+     ChunkDataGenerationQueue.Sort([this](const FIntVector2& A, const FIntVector2& B) {
+         return DistSquared(CurrentPlayerChunk, A) < DistSquared(CurrentPlayerChunk, B);
+     });
 }
 
 
@@ -266,24 +330,134 @@ AChunkBase* AChunkWorld::LoadChunkAtPosition(const FIntVector2& ChunkCoordinates
         return Existing;
     }
 
-    AChunkBase* NewChunk = CreateAndInitializeChunk(ChunkCoordinates);
-    return NewChunk;
+    // Edits from earlier visits or sessions come first; generation is queued once they are in
+    if (RequestChunkRecord(ChunkCoordinates))
+    {
+        return nullptr;
+    }
+
+    // Column data is generated in the background; the actor is spawned once it is ready
+    QueueChunkGeneration(ChunkCoordinates);
+    return nullptr;
+}
+
+void AChunkWorld::QueueChunkGeneration(const FIntVector2& ChunkCoordinates)
+{
+    if (IsChunkDataPending(ChunkCoordinates)) return;
+
+    ChunkDataGenerationQueue.Add(ChunkCoordinates);
+}
+
+bool AChunkWorld::IsChunkDataPending(const FIntVector2& ChunkCoordinates) const
+{
+    return ChunksGeneratingData.Contains(ChunkCoordinates) || ChunkDataGenerationQueue.Contains(ChunkCoordinates)
+        || ChunksReadingRecords.Contains(ChunkCoordinates);
+}
+
+void AChunkWorld::ProcessChunksDataGeneration()
+{
+    if (!TerrainGenerator || !TerrainGenerator->IsNoiseInitialized()) return;
+
+    const FTerrainGeneratorStatePtr GeneratorState = TerrainGenerator->GetState();
+    if (!GeneratorState) return;
+
+    const int32 NumToStart = FMath::Min(ChunkDataGenerationQueue.Num(), MaxConcurrentGenerationTasks - RunningGenerationTasks);
+    if (NumToStart <= 0) return;
+
+    for (int32 i = 0; i < NumToStart; ++i)
+    {
+        const FIntVector2 ChunkCoord = ChunkDataGenerationQueue[i];
+        ChunksGeneratingData.Add(ChunkCoord);
+        ++RunningGenerationTasks;
+
+        (new FAutoDeleteAsyncTask<FChunkGenerationAsync>(this, GeneratorState, ChunkCoord, GenerationId))->StartBackgroundTask();
+    }
+    ChunkDataGenerationQueue.RemoveAt(0, NumToStart);
+}
+
+void AChunkWorld::OnChunkVoxelsGenerated(const FIntVector2& ChunkCoordinates, uint32 InGenerationId, FChunkVoxels&& Voxels)
+{
+    --RunningGenerationTasks;
+
+    // Stale result from before a regeneration, or the world is shutting down
+    if (!bWorldInitialized || InGenerationId != GenerationId) return;
+
+    ChunksGeneratingData.Remove(ChunkCoordinates);
+
+    // The player may have moved away while the task was running
+    if (Voxels.IsEmpty() || ChunksData.Contains(ChunkCoordinates) || !IsWithinLoadSquare(ChunkCoordinates)) return;
+
+    // Player edits go over the structures, as they were made after them
+    FChunkEditDelta* Edits = UnloadedChunkEdits.Find(ChunkCoordinates);
+    if (Edits)
+    {
+        Edits->Apply(Voxels);
+    }
+
+    if (AChunkBase* Chunk = CreateAndInitializeChunk(ChunkCoordinates, MoveTemp(Voxels)))
+    {
+        bVisibleChunksDirty = true;
+
+        if (Edits)
+        {
+            Chunk->SetEdits(MoveTemp(*Edits));
+            UnloadedChunkEdits.Remove(ChunkCoordinates);
+            ++ChunksReplayed;
+        }
+    }
+}
+
+void AChunkWorld::FlushDeferredBlockChanges()
+{
+    for (auto It = ChunksWithDeferredBlockChanges.CreateIterator(); It; ++It)
+    {
+        AChunkBase* Chunk = ChunksData.FindRef(*It);
+        if (!IsValid(Chunk) || Chunk->ApplyDeferredBlockChanges())
+        {
+            It.RemoveCurrent();
+        }
+    }
+}
+
+void AChunkWorld::NotifyMeshTaskCompleted(AChunkBase* Chunk)
+{
+    Chunk->bIsProcessingMesh = false;
+    --RunningMeshTasks;
 }
 
 AChunkBase* AChunkWorld::TryRestoreSavedChunk(const FIntVector2& ChunkCoordinates)
 {
-    if (!SavedChunkColumns.Contains(ChunkCoordinates))
+    FEncodedChunkVoxels Encoded;
+    if (!TakeSavedChunk(ChunkCoordinates, Encoded))
     {
         return nullptr;
     }
 
-    TArray<FChunkColumn> Columns = SavedChunkColumns.FindAndRemoveChecked(ChunkCoordinates);
+    FChunkVoxels Voxels;
+    {
+        FScopedGenerationStageTimer Timer(SavedChunkStats.DecodeCycles);
+        Encoded.Decode(Voxels);
+    }
+    SavedChunkStats.ChunksDecoded.fetch_add(1, std::memory_order_relaxed);
+
+    if (bPackLoadedChunks)
+    {
+        Voxels.Pack();
+    }
+
     AChunkBase* Chunk = SpawnChunkActorAt(ChunkCoordinates);
     if (Chunk)
     {
-        Chunk->SetColumns(MoveTemp(Columns));
+        Chunk->SetVoxels(MoveTemp(Voxels));
         ChunksData.Add(ChunkCoordinates, Chunk);
     }
+
+    // The cached voxels already hold the edits; the chunk takes them back to persist on its next unload
+    FChunkEditDelta Edits;
+    if (UnloadedChunkEdits.RemoveAndCopyValue(ChunkCoordinates, Edits) && Chunk)
+    {
+        Chunk->SetEdits(MoveTemp(Edits));
+    }
     return Chunk;
 }
 
@@ -296,35 +470,18 @@ AChunkBase* AChunkWorld::GetExistingChunk(const FIntVector2& ChunkCoordinates) c
     return nullptr;
 }
 
-AChunkBase* AChunkWorld::CreateAndInitializeChunk(const FIntVector2& ChunkCoordinates)
+AChunkBase* AChunkWorld::CreateAndInitializeChunk(const FIntVector2& ChunkCoordinates, FChunkVoxels&& Voxels)
 {
     if (!ChunkClass) return nullptr;
 
     AChunkBase* Chunk = SpawnChunkActorAt(ChunkCoordinates);
     if (!Chunk) return nullptr;
 
-    // Generate column data
-    const int32 Count = ChunkSize * ChunkSize;
-    TArray<FChunkColumn> Columns;
-    Columns.SetNum(Count);
-
-    for (int32 x = 0; x < ChunkSize; ++x)
+    if (bPackLoadedChunks)
     {
-        for (int32 y = 0; y < ChunkSize; ++y)
-        {
-            int32 idx = FChunkData::GetColumnIndexFromLocal(x, y, ChunkSize);
-            int32 gx  = ChunkCoordinates.X * ChunkSize + x;
-            int32 gy  = ChunkCoordinates.Y * ChunkSize + y;
-
-            Columns[idx] = TerrainGenerator->GenerateColumnData(gx, gy);
-            TerrainGenerator->PopulateColumnBlocks(Columns[idx]);
-        }
+        Voxels.Pack();
     }
-
-    FRandomStream Stream(Seed + ChunkCoordinates.X * 73856093 ^ ChunkCoordinates.Y * 19349663);
-    TerrainGenerator->DecorateChunkWithFoliage(Columns, ChunkCoordinates, Stream);
-
-    Chunk->SetColumns(Columns);
+    Chunk->SetVoxels(MoveTemp(Voxels));
     ChunksData.Add(ChunkCoordinates, Chunk);
 
     return Chunk;
@@ -354,7 +511,16 @@ void AChunkWorld::DestroyChunkActor(const FIntVector2& ChunkCoordinates)
 {
     if (AChunkBase* ChunkToDestroy = ChunksData.FindRef(ChunkCoordinates))
     {
-        SavedChunkColumns.Add(ChunkCoordinates, ChunkToDestroy->GetColumns());
+        // Nothing is kept once the world is shutting down
+        if (bWorldInitialized && ChunkToDestroy->IsModified())
+        {
+            SaveChunk(ChunkCoordinates, *ChunkToDestroy);
+        }
+        else if (bWorldInitialized)
+        {
+            // Regenerated from the seed on return
+            ++ChunksDropped;
+        }
         
         if (IsValid(ChunkToDestroy))
         {
@@ -367,6 +533,225 @@ void AChunkWorld::DestroyChunkActor(const FIntVector2& ChunkCoordinates)
     VisibleChunks.Remove(ChunkCoordinates);
 }
 
+void AChunkWorld::SaveChunk(const FIntVector2& ChunkCoordinates, const AChunkBase& Chunk)
+{
+    // The edits are what persists; written in the background, and kept to replay if the voxels below are evicted
+    UnloadedChunkEdits.Add(ChunkCoordinates, Chunk.GetEdits());
+    if (RegionStore)
+    {
+        TArray<FChunkRecordWrite> Records;
+        FChunkRecordWrite& Record = Records.AddDefaulted_GetRef();
+        Record.ChunkCoordinates = ChunkCoordinates;
+        Record.Edits = Chunk.GetEdits();
+        RegionStore->Write(MoveTemp(Records));
+    }
+
+    FSavedChunk& Saved = SavedChunks.Add(ChunkCoordinates);
+    {
+        FScopedGenerationStageTimer Timer(SavedChunkStats.EncodeCycles);
+        Saved.Voxels.Encode(Chunk.GetVoxels());
+    }
+    SavedChunkStats.AddEncoded(Saved.Voxels);
+    Saved.LastUsed = ++SavedChunkUseCounter;
+    SavedChunkBytes += Saved.Voxels.GetAllocatedSize();
+
+    EvictSavedChunksOverBudget();
+}
+
+bool AChunkWorld::TakeSavedChunk(const FIntVector2& ChunkCoordinates, FEncodedChunkVoxels& OutEncoded)
+{
+    if (FSavedChunk* Saved = SavedChunks.Find(ChunkCoordinates))
+    {
+        SavedChunkBytes -= Saved->Voxels.GetAllocatedSize();
+        OutEncoded = MoveTemp(Saved->Voxels);
+        SavedChunks.Remove(ChunkCoordinates);
+        return true;
+    }
+    return false;
+}
+
+void AChunkWorld::EvictSavedChunksOverBudget()
+{
+    const SIZE_T Budget = static_cast<SIZE_T>(SavedChunkCacheBudgetMB) * 1024 * 1024;
+
+    // Evictions are one per unload once the cache is full, so a scan beats keeping a list in sync
+    while (SavedChunkBytes > Budget && !SavedChunks.IsEmpty())
+    {
+        const FIntVector2* Oldest = nullptr;
+        uint64 OldestUse = MAX_uint64;
+        for (const TPair<FIntVector2, FSavedChunk>& Pair : SavedChunks)
+        {
+            if (Pair.Value.LastUsed < OldestUse)
+            {
+                OldestUse = Pair.Value.LastUsed;
+                Oldest = &Pair.Key;
+            }
+        }
+
+        // It comes back by regenerating, then replaying its edits, which stay in UnloadedChunkEdits
+        const FIntVector2 OldestKey = *Oldest;
+        SavedChunkBytes -= SavedChunks[OldestKey].Voxels.GetAllocatedSize();
+        SavedChunks.Remove(OldestKey);
+        ++ChunksEvicted;
+    }
+}
+
+void AChunkWorld::ClearSavedChunks()
+{
+    SavedChunks.Empty();
+    UnloadedChunkEdits.Empty();
+    SavedChunkBytes = 0;
+}
+
+void AChunkWorld::OpenRegionStore()
+{
+    // The old store drains its queued writes in the background, and the new one only touches the files after it
+    UE::Tasks::FTask PreviousStoreDrained;
+    if (RegionStore)
+    {
+        PreviousStoreDrained = RegionStore->Drain();
+        UE::Tasks::Launch(TEXT("ChunkRegionStoreRelease"), [OldStore = MoveTemp(RegionStore)]() mutable
+        {
+            OldStore.Reset();
+        }, UE::Tasks::Prerequisites(PreviousStoreDrained), UE::Tasks::ETaskPriority::BackgroundLow);
+    }
+
+    const FString Directory = FPaths::ProjectSavedDir() / TEXT("Worlds") / FString::Printf(TEXT("Seed%d_%dx%d"),
+        Seed, ChunkSize, FChunkData::GetChunkHeight(this));
+    RegionStore = MakeShared<FChunkRegionStore, ESPMode::ThreadSafe>(Directory, PreviousStoreDrained);
+}
+
+bool AChunkWorld::RequestChunkRecord(const FIntVector2& ChunkCoordinates)
+{
+    // Edits held in memory are at least as new as the record
+    if (!RegionStore || UnloadedChunkEdits.Contains(ChunkCoordinates)) return false;
+    if (ChunksReadingRecords.Contains(ChunkCoordinates)) return true;
+
+    // Most chunks were never edited; once their region's table is in they skip the read
+    const TOptional<bool> bHasRecord = RegionStore->HasRecord(ChunkCoordinates);
+    if (bHasRecord.IsSet() && !bHasRecord.GetValue()) return false;
+
+    ChunksReadingRecords.Add(ChunkCoordinates);
+    const TWeakObjectPtr<AChunkWorld> WorldPtr(this);
+    const uint32 InGenerationId = GenerationId;
+
+    if (!bHasRecord.IsSet())
+    {
+        RegionStore->LoadRecordPresence(ChunkCoordinates, [WorldPtr, ChunkCoordinates, InGenerationId]()
+        {
+            AChunkWorld* World = WorldPtr.Get();
+            if (!World || !World->bWorldInitialized || InGenerationId != World->GenerationId) return;
+
+            // Asked again now that the answer is known
+            World->ChunksReadingRecords.Remove(ChunkCoordinates);
+            if (!World->ChunksData.Contains(ChunkCoordinates) && World->IsWithinLoadSquare(ChunkCoordinates))
+            {
+                World->LoadChunkAtPosition(ChunkCoordinates);
+            }
+        });
+        return true;
+    }
+
+    RegionStore->Read(ChunkCoordinates, [WorldPtr, ChunkCoordinates, InGenerationId](FChunkRecordRead&& Record)
+    {
+        if (AChunkWorld* World = WorldPtr.Get())
+        {
+            World->OnChunkRecordRead(ChunkCoordinates, InGenerationId, MoveTemp(Record));
+        }
+    });
+    return true;
+}
+
+void AChunkWorld::OnChunkRecordRead(const FIntVector2& ChunkCoordinates, uint32 InGenerationId, FChunkRecordRead&& Record)
+{
+    // Stale result from before a regeneration, or the world is shutting down
+    if (!bWorldInitialized || InGenerationId != GenerationId) return;
+
+    ChunksReadingRecords.Remove(ChunkCoordinates);
+
+    // Replayed over the regenerated voxels once they come back
+    if (!Record.Edits.IsEmpty())
+    {
+        UnloadedChunkEdits.Add(ChunkCoordinates, MoveTemp(Record.Edits));
+    }
+
+    if (!ChunksData.Contains(ChunkCoordinates) && IsWithinLoadSquare(ChunkCoordinates))
+    {
+        QueueChunkGeneration(ChunkCoordinates);
+    }
+}
+
+void AChunkWorld::PersistWorld()
+{
+    if (!RegionStore) return;
+
+    TArray<FChunkRecordWrite> Records;
+    for (const TPair<FIntVector2, TObjectPtr<AChunkBase>>& Pair : ChunksData)
+    {
+        if (IsValid(Pair.Value) && Pair.Value->IsModified())
+        {
+            FChunkRecordWrite& Record = Records.AddDefaulted_GetRef();
+            Record.ChunkCoordinates = Pair.Key;
+            Record.Edits = Pair.Value->GetEdits();
+        }
+    }
+    RegionStore->Write(MoveTemp(Records));
+}
+
+void AChunkWorld::ForgetDistantChunks()
+{
+    // Without region files nothing could bring them back
+    if (!RegionStore) return;
+
+    const int32 KeepDistance = LoadDistance + RecordCacheMargin;
+    auto IsDistant = [this, KeepDistance](const FIntVector2& ChunkCoordinates)
+    {
+        return FMath::Abs(ChunkCoordinates.X - CurrentPlayerChunk.X) > KeepDistance
+            || FMath::Abs(ChunkCoordinates.Y - CurrentPlayerChunk.Y) > KeepDistance;
+    };
+
+    // Their edits were written when they unloaded
+    for (auto It = UnloadedChunkEdits.CreateIterator(); It; ++It)
+    {
+        if (IsDistant(It.Key()))
+        {
+            It.RemoveCurrent();
+        }
+    }
+
+    for (auto It = SavedChunks.CreateIterator(); It; ++It)
+    {
+        if (IsDistant(It.Key()))
+        {
+            SavedChunkBytes -= It.Value().Voxels.GetAllocatedSize();
+            It.RemoveCurrent();
+            ++ChunksEvicted;
+        }
+    }
+
+    const FIntPoint PlayerChunk(CurrentPlayerChunk.X, CurrentPlayerChunk.Y);
+    RegionStore->ReleaseRegions(FIntRect(PlayerChunk - FIntPoint(KeepDistance), PlayerChunk + FIntPoint(KeepDistance + 1)));
+}
+
+SIZE_T AChunkWorld::GetSavedChunksAllocatedSize() const
+{
+    return SavedChunks.GetAllocatedSize() + SavedChunkBytes;
+}
+
+void AChunkWorld::LogSavedChunkStats() const
+{
+    const uint64 Encoded = SavedChunkStats.ChunksEncoded.load();
+    const uint64 Decoded = SavedChunkStats.ChunksDecoded.load();
+    const double EncodeSeconds = FChunkEncodingStats::ToSeconds(SavedChunkStats.EncodeCycles);
+    const double DecodeSeconds = FChunkEncodingStats::ToSeconds(SavedChunkStats.DecodeCycles);
+
+    UE_LOG(LogTemp, Display, TEXT("Saved chunks: %d held in %.1f KB, %d edited, %llu encoded at %.2fx (%.3f ms avg), %llu decoded (%.3f ms avg)"),
+        SavedChunks.Num(), GetSavedChunksAllocatedSize() / 1024.0, UnloadedChunkEdits.Num(), Encoded, SavedChunkStats.GetCompressionRatio(),
+        Encoded > 0 ? EncodeSeconds * 1000.0 / Encoded : 0.0, Decoded, Decoded > 0 ? DecodeSeconds * 1000.0 / Decoded : 0.0);
+    UE_LOG(LogTemp, Display, TEXT("Saved chunks: %llu unmodified dropped, %llu evicted, %llu regenerated with edits replayed"),
+        ChunksDropped, ChunksEvicted, ChunksReplayed);
+}
+
 // Processes the mesh generation queue based on VisibleChunks order.
 void AChunkWorld::ProcessChunksMeshGeneration()
 {
@@ -376,12 +761,13 @@ void AChunkWorld::ProcessChunksMeshGeneration()
 
         if (auto* ChunkPtr = ChunksPendingGenerationMap.Find(ChunkCoord))
         {
+            // Wait for neighbour data so border faces are culled correctly
+            if (!AreNeighbourChunksReady(ChunkCoord)) continue;
+
             AChunkBase* ChunkToProcess = *ChunkPtr;
             if (ChunkToProcess && IsValid(ChunkToProcess) && !ChunkToProcess->IsPendingKillPending() && !ChunkToProcess->bIsProcessingMesh)
             {
                 ChunksPendingGenerationMap.Remove(ChunkCoord);
-                ChunkToProcess->bIsProcessingMesh = true;
-                ++RunningMeshTasks;
                 ChunkToProcess->RegenerateMeshAsync();
             }
             else
@@ -397,11 +783,11 @@ void AChunkWorld::ProcessChunksMeshGeneration()
         TArray<FIntVector2> KeysToRemove;
         for (auto It = ChunksPendingGenerationMap.CreateIterator(); It && RunningMeshTasks < MaxConcurrentMeshTasks; ++It)
         {
+            if (!AreNeighbourChunksReady(It.Key())) continue;
+
             AChunkBase* ChunkToProcess = It.Value();
             if (ChunkToProcess && IsValid(ChunkToProcess) && !ChunkToProcess->IsPendingKillPending() && !ChunkToProcess->bIsProcessingMesh)
             {
-                ChunkToProcess->bIsProcessingMesh = true;
-                ++RunningMeshTasks;
                 ChunkToProcess->RegenerateMeshAsync();
                 KeysToRemove.Add(It.Key());
             }
@@ -461,4 +847,25 @@ bool AChunkWorld::IsWithinDrawDistance(const FIntVector2& ChunkCoordinates) cons
 {
      float DistSq = DistSquared(CurrentPlayerChunk, ChunkCoordinates);
      return DistSq <= (DrawDistance * DrawDistance);
+}
+
+// Matches the square region UpdateChunksData keeps loaded
+bool AChunkWorld::IsWithinLoadSquare(const FIntVector2& ChunkCoordinates) const
+{
+    return FMath::Abs(ChunkCoordinates.X - CurrentPlayerChunk.X) <= LoadDistance &&
+           FMath::Abs(ChunkCoordinates.Y - CurrentPlayerChunk.Y) <= LoadDistance;
+}
+
+bool AChunkWorld::AreNeighbourChunksReady(const FIntVector2& ChunkCoordinates) const
+{
+    static const FIntVector2 Offsets[] = { {1, 0}, {-1, 0}, {0, 1}, {0, -1} };
+    for (const FIntVector2& Offset : Offsets)
+    {
+        const FIntVector2 Neighbour(ChunkCoordinates.X + Offset.X, ChunkCoordinates.Y + Offset.Y);
+        if (IsWithinLoadSquare(Neighbour) && !ChunksData.Contains(Neighbour))
+        {
+            return false;
+        }
+    }
+    return true;
 }
\ No newline at end of file
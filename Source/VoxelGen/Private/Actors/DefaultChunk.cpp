@@ -20,39 +20,118 @@ void ADefaultChunk::GenerateMesh()
 {
 	int32 ChunkSize = FChunkData::GetChunkSize(this);
     int32 ChunkHeight = FChunkData::GetChunkHeight(this);
-	
-    for (int x = 0; x < ChunkSize; ++x)
+
+    for (int32 SectionIndex = 0; SectionIndex < Voxels.NumSections(); ++SectionIndex)
     {
-        for (int y = 0; y < ChunkSize; ++y)
+        const FChunkSection Section = Voxels.GetSection(SectionIndex);
+        if (Section.IsEmpty())
         {
-            for (int z = 0; z < ChunkHeight; ++z)
-            {
-                FIntVector CurrentBlockPos(x, y, z);
-                EBlock CurrentBlockType = GetBlockAtPosition(CurrentBlockPos);
-                FBlockSettings CurrentBlockProperties = GetBlockData(CurrentBlockType);
+            continue;
+        }
+
+        const int32 MinZ = SectionIndex * FChunkVoxels::SectionHeight;
+        const int32 MaxZ = FMath::Min(MinZ + FChunkVoxels::SectionHeight, ChunkHeight);
+
+        // Only blocks that hide the faces between two of them have a hidden inside; leaves and glass don't
+        const FBlockSettings SectionBlock = GetBlockData(Section.Block);
+        const bool bHidesOwnFaces = (SectionBlock.bIsSolid && !SectionBlock.bIsTransparent) || SectionBlock.MaterialType == EBlockMaterialType::Water;
+        if (Section.IsUniform() && SectionBlock.RenderMode == EBlockRenderMode::Cube && bHidesOwnFaces)
+        {
+            MeshUniformSection(SectionIndex, MinZ, MaxZ);
+            continue;
+        }
 
-                // Skip processing for Air blocks themselves or blocks with no defined properties
-                if (CurrentBlockType == EBlock::Air )
+        for (int x = 0; x < ChunkSize; ++x)
+        {
+            for (int y = 0; y < ChunkSize; ++y)
+            {
+                for (int z = MinZ; z < MaxZ; ++z)
                 {
-                    continue;
+                    MeshBlock(FIntVector(x, y, z));
                 }
-
-            	if (CurrentBlockProperties.RenderMode == EBlockRenderMode::Cube)
-            	{
-            		CreateCubePlanes(CurrentBlockPos, CurrentBlockType, CurrentBlockProperties);
-				}
-            	else if (CurrentBlockProperties.RenderMode == EBlockRenderMode::CrossPlanes)
-            	{
-            		CreateCrossPlanes(CurrentBlockPos, CurrentBlockType, CurrentBlockProperties);
-            	}
-				else if (CurrentBlockProperties.RenderMode == EBlockRenderMode::CustomMesh)
-				{
-				}
             }
         }
     }
 }
 
+void ADefaultChunk::MeshUniformSection(int32 SectionIndex, int32 MinZ, int32 MaxZ)
+{
+	const int32 ChunkSize = FChunkData::GetChunkSize(this);
+
+	// Faces show against any block that isn't solid and opaque (air, water, leaves, foliage), so a side is only
+	// closed by a neighbour section made entirely of one solid, opaque block. A section buried on all six sides is
+	// skipped outright.
+	auto IsOpen = [this](int32 NeighbourSection, const FIntVector2& ChunkOffset)
+	{
+		const FChunkSection Neighbour = GetSectionAt(NeighbourSection, ChunkOffset);
+		if (Neighbour.State != EChunkSectionState::Uniform) return true;
+
+		const FBlockSettings Settings = GetBlockData(Neighbour.Block);
+		return !Settings.bIsSolid || Settings.bIsTransparent;
+	};
+	const bool bOpenBelow = IsOpen(SectionIndex - 1, FIntVector2(0, 0));
+	const bool bOpenAbove = IsOpen(SectionIndex + 1, FIntVector2(0, 0));
+	const bool bOpenMinX = IsOpen(SectionIndex, FIntVector2(-1, 0));
+	const bool bOpenMaxX = IsOpen(SectionIndex, FIntVector2(1, 0));
+	const bool bOpenMinY = IsOpen(SectionIndex, FIntVector2(0, -1));
+	const bool bOpenMaxY = IsOpen(SectionIndex, FIntVector2(0, 1));
+
+	if (!bOpenBelow && !bOpenAbove && !bOpenMinX && !bOpenMaxX && !bOpenMinY && !bOpenMaxY)
+	{
+		return;
+	}
+
+	for (int32 x = 0; x < ChunkSize; ++x)
+	{
+		for (int32 y = 0; y < ChunkSize; ++y)
+		{
+			const bool bOpenSide = (x == 0 && bOpenMinX) || (x == ChunkSize - 1 && bOpenMaxX) ||
+				(y == 0 && bOpenMinY) || (y == ChunkSize - 1 && bOpenMaxY);
+			if (bOpenSide)
+			{
+				for (int32 z = MinZ; z < MaxZ; ++z)
+				{
+					MeshBlock(FIntVector(x, y, z));
+				}
+				continue;
+			}
+
+			if (bOpenBelow)
+			{
+				MeshBlock(FIntVector(x, y, MinZ));
+			}
+			if (bOpenAbove && MaxZ - 1 > MinZ)
+			{
+				MeshBlock(FIntVector(x, y, MaxZ - 1));
+			}
+		}
+	}
+}
+
+void ADefaultChunk::MeshBlock(const FIntVector& CurrentBlockPos)
+{
+	EBlock CurrentBlockType = GetBlockAtPosition(CurrentBlockPos);
+
+	// Skip processing for Air blocks themselves or blocks with no defined properties
+	if (CurrentBlockType == EBlock::Air )
+	{
+		return;
+	}
+
+	FBlockSettings CurrentBlockProperties = GetBlockData(CurrentBlockType);
+	if (CurrentBlockProperties.RenderMode == EBlockRenderMode::Cube)
+	{
+		CreateCubePlanes(CurrentBlockPos, CurrentBlockType, CurrentBlockProperties);
+	}
+	else if (CurrentBlockProperties.RenderMode == EBlockRenderMode::CrossPlanes)
+	{
+		CreateCrossPlanes(CurrentBlockPos, CurrentBlockType, CurrentBlockProperties);
+	}
+	else if (CurrentBlockProperties.RenderMode == EBlockRenderMode::CustomMesh)
+	{
+	}
+}
+
 void ADefaultChunk::CreateCubePlanes(const FIntVector& CurrentBlockPos, EBlock Block, const FBlockSettings& BlockSettings)
 {
 	// Iterate through 6 directions
@@ -7,8 +7,29 @@
 
 void AGreedyChunk::GenerateMesh()
 {
-    if (!GetWorld()) return;
-    
+    if (!GetWorld() || Voxels.IsEmpty()) return;
+
+    // Determine if a block is "Solid Opaque"
+    auto IsSolidOpaque = [&](EBlock BlockType, const FBlockSettings& Settings) -> bool {
+        if (BlockType == EBlock::Air) return false;
+        return Settings.bIsSolid && !Settings.bIsTransparent;
+    };
+
+    // Sections filled with one block that shows no faces against itself (air, solid opaque or transparent);
+    // a slice comparing two blocks inside one of them has an empty mask
+    const int32 NumSections = Voxels.NumSections();
+    TArray<bool, TInlineAllocator<32>> SectionHidesFaces;
+    SectionHidesFaces.SetNumZeroed(NumSections);
+    for (int32 SectionIndex = 0; SectionIndex < NumSections; ++SectionIndex)
+    {
+        const FChunkSection Section = Voxels.GetSection(SectionIndex);
+        if (Section.IsUniform())
+        {
+            const FBlockSettings Settings = GetBlockData(Section.Block);
+            SectionHidesFaces[SectionIndex] = Section.IsEmpty() || IsSolidOpaque(Section.Block, Settings) || Settings.bIsTransparent;
+        }
+    }
+
     // Iterate over each axis (X, Y, Z)
     for (int Axis = 0; Axis < 3; ++Axis)
     {
@@ -47,18 +68,26 @@ void AGreedyChunk::GenerateMesh()
         }
         Mask.SetNum(InnerAxisSize1 * InnerAxisSize2);
 
-        // Determine if a block is "Solid Opaque"
-        auto IsSolidOpaque = [&](EBlock BlockType, const FBlockSettings& Settings) -> bool {
-            if (BlockType == EBlock::Air) return false;
-            return Settings.bIsSolid && !Settings.bIsTransparent;
-        };
-
         // Sweep along the current axis
         int MainAxisSize = (Axis == 2) ? ChunkHeight : Size; // Determine the size along the current axis
         for (ChunkItr[Axis] = -1; ChunkItr[Axis] < MainAxisSize;)
         {
             int N = 0;
 
+            // Both slices are inside this chunk, so only the section flags decide whether a cell can have a face
+            const bool bInteriorSlice = ChunkItr[Axis] >= 0 && ChunkItr[Axis] + 1 < MainAxisSize;
+            if (Axis == 2 && bInteriorSlice)
+            {
+                const int32 SectionIndex = FChunkVoxels::GetSectionIndex(ChunkItr[Axis]);
+                const int32 NextSectionIndex = FChunkVoxels::GetSectionIndex(ChunkItr[Axis] + 1);
+                if (SectionHidesFaces[SectionIndex] && SectionHidesFaces[NextSectionIndex] &&
+                    Voxels.GetSection(SectionIndex).Block == Voxels.GetSection(NextSectionIndex).Block)
+                {
+                    ++ChunkItr[Axis];
+                    continue;
+                }
+            }
+
             // Traverse along Axis2 (e.g., Y) - Height of the slice
             for (ChunkItr[Axis2] = 0; ChunkItr[Axis2] < InnerAxisSize2; ++ChunkItr[Axis2])
             {
@@ -66,6 +95,12 @@ void AGreedyChunk::GenerateMesh()
                 for (ChunkItr[Axis1] = 0; ChunkItr[Axis1] < InnerAxisSize1; ++ChunkItr[Axis1])
                 {
                     if (!GetWorld() || !this) return;
+                    if (Axis != 2 && bInteriorSlice && SectionHidesFaces[FChunkVoxels::GetSectionIndex(ChunkItr[2])])
+                    {
+                        Mask[N++] = FMask{FBlockSettings(), 0};
+                        continue;
+                    }
+
                     const EBlock CurrentBlockType = GetBlockAtPosition(ChunkItr);
                     FBlockSettings CurrentSettings = GetBlockData(CurrentBlockType);
 
@@ -220,20 +255,32 @@ void AGreedyChunk::GenerateMesh()
     const int32 ChunkSize   = FChunkData::GetChunkSize(GetWorld());
     const int32 ChunkHeight = FChunkData::GetChunkHeight(GetWorld());
 
-    for (int x = 0; x < ChunkSize; ++x)
+    for (int32 SectionIndex = 0; SectionIndex < NumSections; ++SectionIndex)
     {
-        for (int y = 0; y < ChunkSize; ++y)
+        // A uniform section holds cross planes only if its one block is one
+        const FChunkSection Section = Voxels.GetSection(SectionIndex);
+        if (Section.IsEmpty() || (Section.IsUniform() && GetBlockData(Section.Block).RenderMode != EBlockRenderMode::CrossPlanes))
         {
-            for (int z = 0; z < ChunkHeight; ++z)
+            continue;
+        }
+
+        const int32 MinZ = SectionIndex * FChunkVoxels::SectionHeight;
+        const int32 MaxZ = FMath::Min(MinZ + FChunkVoxels::SectionHeight, ChunkHeight);
+        for (int x = 0; x < ChunkSize; ++x)
+        {
+            for (int y = 0; y < ChunkSize; ++y)
             {
-                FIntVector Pos(x,y,z);
-                EBlock BlockType = GetBlockAtPosition(Pos);
-                FBlockSettings Settings = GetBlockData(BlockType);
+                for (int z = MinZ; z < MaxZ; ++z)
+                {
+                    FIntVector Pos(x,y,z);
+                    EBlock BlockType = GetBlockAtPosition(Pos);
+                    FBlockSettings Settings = GetBlockData(BlockType);
 
-                if (Settings.RenderMode != EBlockRenderMode::CrossPlanes)
-                    continue;
+                    if (Settings.RenderMode != EBlockRenderMode::CrossPlanes)
+                        continue;
 
-                CreateCrossPlanes(Pos, BlockType, Settings);
+                    CreateCrossPlanes(Pos, BlockType, Settings);
+                }
             }
         }
     }
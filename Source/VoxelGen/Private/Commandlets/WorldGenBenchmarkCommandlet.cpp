@@ -0,0 +1,294 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Commandlets/WorldGenBenchmarkCommandlet.h"
+
+#include "Async/ParallelFor.h"
+#include "Engine/DataTable.h"
+#include "GameInstances/WorldGameInstance.h"
+#include "HAL/PlatformMemory.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Objects/TerrainGenerator.h"
+#include "Structs/ChunkColumn.h"
+#include "Structs/ChunkData.h"
+#include "Structs/ChunkEncodingStats.h"
+#include "Structs/ChunkVoxels.h"
+#include "Structs/EncodedChunkVoxels.h"
+#include "Structs/NoiseGenerationPreset.h"
+
+UWorldGenBenchmarkCommandlet::UWorldGenBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 UWorldGenBenchmarkCommandlet::Main(const FString& Params)
+{
+	const UWorldGameInstance* Defaults = GetDefault<UWorldGameInstance>();
+
+	FString PresetPath;
+	FString BiomesPath;
+	FString GeneratorClassPath;
+	FString OutputPath = FPaths::ProjectSavedDir() / TEXT("WorldGenBenchmark.json");
+	int32 Seed = Defaults->Seed;
+	int32 RegionSize = 16;
+	int32 ChunkSize = Defaults->ChunkSize;
+	int32 ChunkHeight = Defaults->ChunkHeight;
+
+	FParse::Value(*Params, TEXT("Preset="), PresetPath);
+	FParse::Value(*Params, TEXT("Biomes="), BiomesPath);
+	FParse::Value(*Params, TEXT("Generator="), GeneratorClassPath);
+	FParse::Value(*Params, TEXT("Output="), OutputPath);
+	FParse::Value(*Params, TEXT("Seed="), Seed);
+	FParse::Value(*Params, TEXT("Size="), RegionSize);
+	FParse::Value(*Params, TEXT("ChunkSize="), ChunkSize);
+	FParse::Value(*Params, TEXT("ChunkHeight="), ChunkHeight);
+
+	UNoiseGenerationPreset* Preset = LoadObject<UNoiseGenerationPreset>(nullptr, *PresetPath);
+	if (!Preset)
+	{
+		UE_LOG(LogTemp, Error, TEXT("WorldGenBenchmark: could not load noise preset '%s' (-Preset=)"), *PresetPath);
+		return 1;
+	}
+
+	UDataTable* Biomes = BiomesPath.IsEmpty() ? nullptr : LoadObject<UDataTable>(nullptr, *BiomesPath);
+	if (!BiomesPath.IsEmpty() && !Biomes)
+	{
+		UE_LOG(LogTemp, Error, TEXT("WorldGenBenchmark: could not load biome table '%s' (-Biomes=)"), *BiomesPath);
+		return 1;
+	}
+
+	// A generator blueprint carries the splines and thresholds; the native class falls back to its defaults
+	UClass* GeneratorClass = UTerrainGenerator::StaticClass();
+	if (!GeneratorClassPath.IsEmpty())
+	{
+		GeneratorClass = LoadClass<UTerrainGenerator>(nullptr, *GeneratorClassPath);
+		if (!GeneratorClass)
+		{
+			UE_LOG(LogTemp, Error, TEXT("WorldGenBenchmark: could not load generator class '%s' (-Generator=)"), *GeneratorClassPath);
+			return 1;
+		}
+	}
+
+	RegionSize = FMath::Max(1, RegionSize);
+
+	UTerrainGenerator* Generator = NewObject<UTerrainGenerator>(GetTransientPackage(), GeneratorClass);
+	Generator->AddToRoot();
+	Generator->NoiseGenerationPreset = Preset;
+	if (Biomes)
+	{
+		Generator->BiomesTable = Biomes;
+	}
+	Generator->InitializeStandalone(Seed, ChunkSize, ChunkHeight);
+
+	if (!Generator->IsNoiseInitialized() || !Generator->GetState())
+	{
+		Generator->RemoveFromRoot();
+		return 1;
+	}
+
+	const int32 NumThreads = FTaskGraphInterface::Get().GetNumWorkerThreads() + 1;
+
+	// Each pass starts from a fresh snapshot, and so a cold field cache, so both measure the same work
+	Generator->RebuildState();
+	Generator->ResetGenerationStats();
+	const double SingleThreadSeconds = RunPass(Generator, RegionSize, false);
+
+	FString Json;
+	Json += TEXT("{\n");
+	Json += FString::Printf(TEXT("\t\"preset\": \"%s\",\n"), *Preset->GetPathName());
+	Json += FString::Printf(TEXT("\t\"biomes\": \"%s\",\n"), Biomes ? *Biomes->GetPathName() : TEXT(""));
+	Json += FString::Printf(TEXT("\t\"seed\": %d,\n"), Seed);
+	Json += FString::Printf(TEXT("\t\"regionSize\": %d,\n"), RegionSize);
+	Json += FString::Printf(TEXT("\t\"chunkSize\": %d,\n"), ChunkSize);
+	Json += FString::Printf(TEXT("\t\"chunkHeight\": %d,\n"), ChunkHeight);
+	WritePassJson(Json, TEXT("singleThreaded"), Generator, SingleThreadSeconds, RegionSize, ChunkSize, 1);
+	Json += TEXT(",\n");
+
+	Generator->RebuildState();
+	Generator->ResetGenerationStats();
+	const double MultiThreadSeconds = RunPass(Generator, RegionSize, true);
+
+	WritePassJson(Json, TEXT("multiThreaded"), Generator, MultiThreadSeconds, RegionSize, ChunkSize, NumThreads);
+	Json += TEXT(",\n");
+
+	// Surface queries have to report what generation builds, so placement and generation agree at biome borders
+	int32 BorderColumns = 0;
+	const int32 SurfaceMismatches = RunSurfaceConsistencyPass(Generator, RegionSize, BorderColumns);
+	Json += FString::Printf(TEXT("\t\"surfaceQueries\": { \"borderColumns\": %d, \"mismatches\": %d },\n"), BorderColumns, SurfaceMismatches);
+
+	// Saved-chunk cache encoding, over the same region with a warm field cache
+	FChunkEncodingStats EncodingStats;
+	RunEncodingPass(Generator, RegionSize, EncodingStats);
+	const uint64 ChunksEncoded = FMath::Max<uint64>(EncodingStats.ChunksEncoded.load(), 1);
+	Json += TEXT("\t\"savedChunks\": {\n");
+	Json += FString::Printf(TEXT("\t\t\"chunks\": %llu,\n"), EncodingStats.ChunksEncoded.load());
+	Json += FString::Printf(TEXT("\t\t\"rawBytes\": %llu,\n"), EncodingStats.RawBytesEncoded.load());
+	Json += FString::Printf(TEXT("\t\t\"encodedBytes\": %llu,\n"), EncodingStats.EncodedBytes.load());
+	Json += FString::Printf(TEXT("\t\t\"compressionRatio\": %f,\n"), EncodingStats.GetCompressionRatio());
+	Json += FString::Printf(TEXT("\t\t\"encodeSecondsPerChunk\": %f,\n"), FChunkEncodingStats::ToSeconds(EncodingStats.EncodeCycles) / ChunksEncoded);
+	Json += FString::Printf(TEXT("\t\t\"decodeSecondsPerChunk\": %f\n"), FChunkEncodingStats::ToSeconds(EncodingStats.DecodeCycles) / ChunksEncoded);
+	Json += TEXT("\t},\n");
+
+	const FPlatformMemoryStats MemoryStats = FPlatformMemory::GetStats();
+	Json += FString::Printf(TEXT("\t\"peakUsedPhysicalBytes\": %llu,\n"), static_cast<uint64>(MemoryStats.PeakUsedPhysical));
+	Json += FString::Printf(TEXT("\t\"peakUsedVirtualBytes\": %llu\n"), static_cast<uint64>(MemoryStats.PeakUsedVirtual));
+	Json += TEXT("}\n");
+
+	Generator->RemoveFromRoot();
+
+	UE_LOG(LogTemp, Display, TEXT("%s"), *Json);
+	if (!FFileHelper::SaveStringToFile(Json, *OutputPath))
+	{
+		UE_LOG(LogTemp, Error, TEXT("WorldGenBenchmark: could not write '%s'"), *OutputPath);
+		return 1;
+	}
+
+	UE_LOG(LogTemp, Display, TEXT("WorldGenBenchmark: wrote %s"), *OutputPath);
+
+	if (SurfaceMismatches > 0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("WorldGenBenchmark: %d columns differ between surface queries and generation"), SurfaceMismatches);
+		return 1;
+	}
+	return 0;
+}
+
+double UWorldGenBenchmarkCommandlet::RunPass(UTerrainGenerator* Generator, int32 RegionSize, bool bMultiThreaded) const
+{
+	// Region centered on the origin so negative coordinates are covered too
+	const int32 HalfSize = RegionSize / 2;
+	const int32 NumChunks = RegionSize * RegionSize;
+
+	const FTerrainGeneratorStatePtr State = Generator->GetState();
+	const double StartSeconds = FPlatformTime::Seconds();
+
+	ParallelFor(NumChunks, [&State, RegionSize, HalfSize](int32 Index)
+	{
+		const FIntVector2 ChunkCoordinates(Index % RegionSize - HalfSize, Index / RegionSize - HalfSize);
+
+		FChunkVoxels Voxels;
+		State->GenerateChunk(ChunkCoordinates, Voxels);
+	}, bMultiThreaded ? EParallelForFlags::None : EParallelForFlags::ForceSingleThread);
+
+	return FPlatformTime::Seconds() - StartSeconds;
+}
+
+int32 UWorldGenBenchmarkCommandlet::RunSurfaceConsistencyPass(UTerrainGenerator* Generator, int32 RegionSize, int32& OutBorderColumns) const
+{
+	const int32 HalfSize = RegionSize / 2;
+	const FTerrainGeneratorStatePtr State = Generator->GetState();
+	const int32 ChunkSize = State->GetChunkSize();
+	const int32 RegionColumns = RegionSize * ChunkSize;
+
+	const FIntPoint Origin(-HalfSize * ChunkSize, -HalfSize * ChunkSize);
+	TArray<FTerrainSurfaceSample> RegionSamples;
+	State->QuerySurfaceRegion(FIntRect(Origin, Origin + FIntPoint(RegionColumns, RegionColumns)), RegionSamples);
+
+	int32 Mismatches = 0;
+	OutBorderColumns = 0;
+
+	TArray<FChunkColumn> Columns;
+	for (int32 ChunkY = 0; ChunkY < RegionSize; ++ChunkY)
+	{
+		for (int32 ChunkX = 0; ChunkX < RegionSize; ++ChunkX)
+		{
+			State->GenerateChunkColumns(FIntVector2(ChunkX - HalfSize, ChunkY - HalfSize), Columns);
+
+			for (int32 y = 0; y < ChunkSize; ++y)
+			{
+				for (int32 x = 0; x < ChunkSize; ++x)
+				{
+					const FChunkColumn& Column = Columns[FChunkData::GetColumnIndexFromLocal(x, y, ChunkSize)];
+					const int32 RegionX = ChunkX * ChunkSize + x;
+					const int32 RegionY = ChunkY * ChunkSize + y;
+					const FTerrainSurfaceSample& RegionSample = RegionSamples[RegionX + RegionY * RegionColumns];
+					const FTerrainSurfaceSample Sample = State->QuerySurface(Column.X, Column.Y);
+
+					if (Sample.Height != Column.Height || Sample.Biome != Column.GetBiomeType()
+						|| RegionSample.Height != Column.Height || RegionSample.Biome != Column.GetBiomeType())
+					{
+						++Mismatches;
+					}
+
+					if ((RegionX > 0 && RegionSamples[RegionX - 1 + RegionY * RegionColumns].Biome != RegionSample.Biome)
+						|| (RegionY > 0 && RegionSamples[RegionX + (RegionY - 1) * RegionColumns].Biome != RegionSample.Biome))
+					{
+						++OutBorderColumns;
+					}
+				}
+			}
+		}
+	}
+
+	return Mismatches;
+}
+
+void UWorldGenBenchmarkCommandlet::RunEncodingPass(UTerrainGenerator* Generator, int32 RegionSize, FChunkEncodingStats& OutStats) const
+{
+	const int32 HalfSize = RegionSize / 2;
+	const int32 NumChunks = RegionSize * RegionSize;
+
+	const FTerrainGeneratorStatePtr State = Generator->GetState();
+
+	ParallelFor(NumChunks, [&State, &OutStats, RegionSize, HalfSize](int32 Index)
+	{
+		const FIntVector2 ChunkCoordinates(Index % RegionSize - HalfSize, Index / RegionSize - HalfSize);
+
+		FChunkVoxels Voxels;
+		State->GenerateChunk(ChunkCoordinates, Voxels);
+
+		FEncodedChunkVoxels Encoded;
+		{
+			FScopedGenerationStageTimer Timer(OutStats.EncodeCycles);
+			Encoded.Encode(Voxels);
+		}
+		OutStats.AddEncoded(Encoded);
+
+		FChunkVoxels Decoded;
+		{
+			FScopedGenerationStageTimer Timer(OutStats.DecodeCycles);
+			Encoded.Decode(Decoded);
+		}
+		OutStats.ChunksDecoded.fetch_add(1, std::memory_order_relaxed);
+
+		check(Decoded.Blocks == Voxels.Blocks);
+	});
+}
+
+void UWorldGenBenchmarkCommandlet::WritePassJson(FString& Json, const TCHAR* Name, const UTerrainGenerator* Generator,
+	double Seconds, int32 RegionSize, int32 ChunkSize, int32 NumThreads) const
+{
+	const FTerrainGenerationStats& Stats = Generator->GetGenerationStats();
+	const double Chunks = static_cast<double>(Stats.ChunksGenerated.load());
+	const double Columns = Chunks * ChunkSize * ChunkSize;
+	const double SafeSeconds = FMath::Max(Seconds, UE_DOUBLE_SMALL_NUMBER);
+
+	// Stage times are summed over all threads, so in the multi-threaded pass they can exceed the wall time
+	Json += FString::Printf(TEXT("\t\"%s\": {\n"), Name);
+	Json += FString::Printf(TEXT("\t\t\"threads\": %d,\n"), NumThreads);
+	Json += FString::Printf(TEXT("\t\t\"chunks\": %d,\n"), RegionSize * RegionSize);
+	Json += FString::Printf(TEXT("\t\t\"seconds\": %f,\n"), Seconds);
+	Json += FString::Printf(TEXT("\t\t\"chunksPerSecond\": %f,\n"), Chunks / SafeSeconds);
+	Json += FString::Printf(TEXT("\t\t\"columnsPerSecond\": %f,\n"), Columns / SafeSeconds);
+	Json += FString::Printf(TEXT("\t\t\"fieldColumnsGenerated\": %llu,\n"), Stats.FieldColumnsGenerated.load());
+	Json += FString::Printf(TEXT("\t\t\"densityVoxelsEvaluated\": %llu,\n"), Stats.DensityVoxelsEvaluated.load());
+	Json += FString::Printf(TEXT("\t\t\"densityNodesSampled\": %llu,\n"), Stats.DensityNodesSampled.load());
+	Json += FString::Printf(TEXT("\t\t\"foliageSitesEvaluated\": %llu,\n"), Stats.FoliageSitesEvaluated.load());
+	Json += FString::Printf(TEXT("\t\t\"sections\": { \"empty\": %llu, \"uniform\": %llu, \"mixed\": %llu },\n"),
+		Stats.SectionsEmpty.load(), Stats.SectionsUniform.load(), Stats.SectionsMixed.load());
+	Json += TEXT("\t\t\"stageSeconds\": {\n");
+	Json += FString::Printf(TEXT("\t\t\t\"noise\": %f,\n"), FTerrainGenerationStats::ToSeconds(Stats.NoiseCycles));
+	Json += FString::Printf(TEXT("\t\t\t\"splines\": %f,\n"), FTerrainGenerationStats::ToSeconds(Stats.SplineCycles));
+	Json += FString::Printf(TEXT("\t\t\t\"height\": %f,\n"), FTerrainGenerationStats::ToSeconds(Stats.HeightCycles));
+	Json += FString::Printf(TEXT("\t\t\t\"classification\": %f,\n"), FTerrainGenerationStats::ToSeconds(Stats.ClassificationCycles));
+	Json += FString::Printf(TEXT("\t\t\t\"biomeBlend\": %f,\n"), FTerrainGenerationStats::ToSeconds(Stats.BlendCycles));
+	Json += FString::Printf(TEXT("\t\t\t\"populate\": %f,\n"), FTerrainGenerationStats::ToSeconds(Stats.PopulateCycles));
+	Json += FString::Printf(TEXT("\t\t\t\"density\": %f,\n"), FTerrainGenerationStats::ToSeconds(Stats.DensityCycles));
+	Json += FString::Printf(TEXT("\t\t\t\"foliage\": %f\n"), FTerrainGenerationStats::ToSeconds(Stats.FoliageCycles));
+	Json += TEXT("\t\t}\n");
+	Json += TEXT("\t}");
+}
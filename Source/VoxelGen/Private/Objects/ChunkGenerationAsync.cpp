@@ -0,0 +1,37 @@
+﻿#include "Objects/ChunkGenerationAsync.h"
+
+#include "Actors/ChunkWorld.h"
+#include "Async/Async.h"
+#include "Structs/ChunkVoxels.h"
+
+FChunkGenerationAsync::FChunkGenerationAsync(AChunkWorld* InWorld, FTerrainGeneratorStatePtr InGeneratorState,
+	const FIntVector2& InChunkCoordinates, uint32 InGenerationId)
+	: WorldPtr(InWorld), GeneratorState(MoveTemp(InGeneratorState)), ChunkCoordinates(InChunkCoordinates),
+	  GenerationId(InGenerationId)
+{
+}
+
+TStatId FChunkGenerationAsync::GetStatId()
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(FChunkGenerationAsync, STATGROUP_ThreadPoolAsyncTasks);
+}
+
+void FChunkGenerationAsync::DoWork()
+{
+	FChunkVoxels Voxels;
+
+	if (GeneratorState)
+	{
+		GeneratorState->GenerateChunk(ChunkCoordinates, Voxels);
+	}
+
+	// Always report back, even with no data, so the world can release the task slot
+	AsyncTask(ENamedThreads::GameThread, [WorldPtr = WorldPtr, ChunkCoordinates = ChunkCoordinates,
+		GenerationId = GenerationId, Voxels = MoveTemp(Voxels)]() mutable
+	{
+		if (AChunkWorld* World = WorldPtr.Get())
+		{
+			World->OnChunkVoxelsGenerated(ChunkCoordinates, GenerationId, MoveTemp(Voxels));
+		}
+	});
+}
@@ -0,0 +1,450 @@
+﻿#include "Objects/ChunkRegionStore.h"
+
+#include "Async/Async.h"
+#include "Async/MappedFileHandle.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFileManager.h"
+#include "Misc/Compression.h"
+#include "Misc/FileHelper.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+namespace
+{
+	constexpr uint32 RegionMagic = 0x47525856; // "VXRG"
+	constexpr uint32 RegionVersion = 3;
+
+	// Below this much dead space a region is never rewritten
+	constexpr int64 MinCompactionBytes = 1024 * 1024;
+
+	// Payloads are the raw size followed by the compressed bytes
+	const FName PayloadCompression = NAME_Oodle;
+
+	// Magic and version, then the edits payload per chunk
+	constexpr int64 GetRegionHeaderSize()
+	{
+		return 2 * sizeof(uint32) + FChunkRegionStore::RegionSize * FChunkRegionStore::RegionSize * 2 * sizeof(uint32);
+	}
+}
+
+FChunkRegionStore::FChunkRegionStore(const FString& InDirectory, const UE::Tasks::FTask& InPrevious)
+	: Directory(InDirectory), Pipe(TEXT("ChunkRegionStore")), Previous(InPrevious)
+{
+}
+
+FChunkRegionStore::~FChunkRegionStore()
+{
+	Flush();
+}
+
+template <typename TaskBodyType>
+UE::Tasks::FTask FChunkRegionStore::Launch(const TCHAR* DebugName, TaskBodyType&& TaskBody)
+{
+	if (Previous.IsValid() && !Previous.IsCompleted())
+	{
+		return Pipe.Launch(DebugName, Forward<TaskBodyType>(TaskBody), UE::Tasks::Prerequisites(Previous), UE::Tasks::ETaskPriority::BackgroundNormal);
+	}
+	return Pipe.Launch(DebugName, Forward<TaskBodyType>(TaskBody), UE::Tasks::ETaskPriority::BackgroundNormal);
+}
+
+void FChunkRegionStore::Write(TArray<FChunkRecordWrite>&& Records)
+{
+	if (Records.IsEmpty()) return;
+
+	// Known on the game thread as soon as it is queued; the pipe writes it before any later read
+	for (const FChunkRecordWrite& Record : Records)
+	{
+		FindOrAddPresence(GetRegionCoordinates(Record.ChunkCoordinates)).Records[GetEntryIndex(Record.ChunkCoordinates)] = true;
+	}
+
+	Launch(TEXT("ChunkRegionWrite"), [this, Records = MoveTemp(Records)]() mutable
+	{
+		TMap<FIntVector2, TArray<FChunkRecordWrite>> RecordsByRegion;
+		for (FChunkRecordWrite& Record : Records)
+		{
+			RecordsByRegion.FindOrAdd(GetRegionCoordinates(Record.ChunkCoordinates)).Add(MoveTemp(Record));
+		}
+
+		for (TPair<FIntVector2, TArray<FChunkRecordWrite>>& Pair : RecordsByRegion)
+		{
+			WriteRecords(Pair.Key, Pair.Value);
+		}
+	});
+}
+
+void FChunkRegionStore::Read(const FIntVector2& ChunkCoordinates, TUniqueFunction<void(FChunkRecordRead&&)>&& OnRead)
+{
+	Launch(TEXT("ChunkRegionRead"), [this, ChunkCoordinates, OnRead = MoveTemp(OnRead)]() mutable
+	{
+		FChunkRecordRead Record;
+		ReadRecord(ChunkCoordinates, Record);
+
+		AsyncTask(ENamedThreads::GameThread, [OnRead = MoveTemp(OnRead), Record = MoveTemp(Record)]() mutable
+		{
+			OnRead(MoveTemp(Record));
+		});
+	});
+}
+
+TOptional<bool> FChunkRegionStore::HasRecord(const FIntVector2& ChunkCoordinates) const
+{
+	const FRegionPresence* RegionPresence = Presence.Find(GetRegionCoordinates(ChunkCoordinates));
+	if (!RegionPresence || !RegionPresence->bLoaded) return {};
+	return RegionPresence->Records[GetEntryIndex(ChunkCoordinates)];
+}
+
+void FChunkRegionStore::LoadRecordPresence(const FIntVector2& ChunkCoordinates, TUniqueFunction<void()>&& OnLoaded)
+{
+	const FIntVector2 RegionCoordinates = GetRegionCoordinates(ChunkCoordinates);
+	FRegionPresence& RegionPresence = FindOrAddPresence(RegionCoordinates);
+	if (RegionPresence.bLoaded)
+	{
+		OnLoaded();
+		return;
+	}
+
+	// One table load per region, however many of its chunks ask
+	RegionPresence.OnLoaded.Add(MoveTemp(OnLoaded));
+	if (RegionPresence.OnLoaded.Num() > 1) return;
+
+	Launch(TEXT("ChunkRegionPresence"), [this, RegionCoordinates]()
+	{
+		const FRegion& Region = GetRegion(RegionCoordinates);
+		TBitArray<> Records(false, Region.Entries.Num());
+		for (int32 EntryIndex = 0; EntryIndex < Region.Entries.Num(); ++EntryIndex)
+		{
+			Records[EntryIndex] = Region.Entries[EntryIndex].Edits.Size > 0;
+		}
+
+		// The store may be handed off and drained before this runs
+		AsyncTask(ENamedThreads::GameThread, [WeakStore = AsWeak(), RegionCoordinates, Records = MoveTemp(Records)]() mutable
+		{
+			if (const TSharedPtr<FChunkRegionStore, ESPMode::ThreadSafe> Store = WeakStore.Pin())
+			{
+				Store->OnRecordPresenceLoaded(RegionCoordinates, MoveTemp(Records));
+			}
+		});
+	});
+}
+
+FChunkRegionStore::FRegionPresence& FChunkRegionStore::FindOrAddPresence(const FIntVector2& RegionCoordinates)
+{
+	FRegionPresence& RegionPresence = Presence.FindOrAdd(RegionCoordinates);
+	if (RegionPresence.Records.IsEmpty())
+	{
+		RegionPresence.Records.Init(false, RegionSize * RegionSize);
+	}
+	return RegionPresence;
+}
+
+void FChunkRegionStore::OnRecordPresenceLoaded(const FIntVector2& RegionCoordinates, TBitArray<>&& Records)
+{
+	FRegionPresence& RegionPresence = FindOrAddPresence(RegionCoordinates);
+
+	// Records queued for writing while the table was loading are already set
+	for (TConstSetBitIterator<> It(Records); It; ++It)
+	{
+		RegionPresence.Records[It.GetIndex()] = true;
+	}
+	RegionPresence.bLoaded = true;
+
+	TArray<TUniqueFunction<void()>> OnLoaded = MoveTemp(RegionPresence.OnLoaded);
+	for (TUniqueFunction<void()>& Callback : OnLoaded)
+	{
+		Callback();
+	}
+}
+
+void FChunkRegionStore::Flush()
+{
+	Previous.Wait();
+	Pipe.WaitUntilEmpty();
+}
+
+UE::Tasks::FTask FChunkRegionStore::Drain()
+{
+	// The pipe runs in order, so this completes after everything queued before it
+	return Launch(TEXT("ChunkRegionDrain"), []() {});
+}
+
+void FChunkRegionStore::ReleaseRegions(const FIntRect& KeepChunks)
+{
+	const FIntVector2 MinRegion = GetRegionCoordinates(FIntVector2(KeepChunks.Min.X, KeepChunks.Min.Y));
+	const FIntVector2 MaxRegion = GetRegionCoordinates(FIntVector2(KeepChunks.Max.X - 1, KeepChunks.Max.Y - 1));
+	auto IsReleased = [MinRegion, MaxRegion](const FIntVector2& RegionCoordinates)
+	{
+		return RegionCoordinates.X < MinRegion.X || RegionCoordinates.X > MaxRegion.X
+			|| RegionCoordinates.Y < MinRegion.Y || RegionCoordinates.Y > MaxRegion.Y;
+	};
+
+	// Regions still loading keep their entry for the chunks waiting on them
+	for (auto It = Presence.CreateIterator(); It; ++It)
+	{
+		if (It.Value().bLoaded && IsReleased(It.Key()))
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	Launch(TEXT("ChunkRegionRelease"), [this, IsReleased]()
+	{
+		for (auto It = Regions.CreateIterator(); It; ++It)
+		{
+			if (IsReleased(It.Key()))
+			{
+				UnmapRegion(*It.Value());
+				It.RemoveCurrent();
+			}
+		}
+	});
+}
+
+FIntVector2 FChunkRegionStore::GetRegionCoordinates(const FIntVector2& ChunkCoordinates)
+{
+	// Floored, so negative chunks fall in negative regions rather than sharing region 0 with negative entry indices
+	return FIntVector2(
+		FMath::FloorToInt(static_cast<float>(ChunkCoordinates.X) / RegionSize),
+		FMath::FloorToInt(static_cast<float>(ChunkCoordinates.Y) / RegionSize));
+}
+
+int32 FChunkRegionStore::GetEntryIndex(const FIntVector2& ChunkCoordinates)
+{
+	const FIntVector2 RegionCoordinates = GetRegionCoordinates(ChunkCoordinates);
+	const int32 LocalX = ChunkCoordinates.X - RegionCoordinates.X * RegionSize;
+	const int32 LocalY = ChunkCoordinates.Y - RegionCoordinates.Y * RegionSize;
+	return LocalX + LocalY * RegionSize;
+}
+
+FChunkRegionStore::FRegion& FChunkRegionStore::GetRegion(const FIntVector2& RegionCoordinates)
+{
+	if (TUniquePtr<FRegion>* Existing = Regions.Find(RegionCoordinates))
+	{
+		return **Existing;
+	}
+
+	TUniquePtr<FRegion>& Region = Regions.Add(RegionCoordinates, MakeUnique<FRegion>());
+	Region->Path = Directory / FString::Printf(TEXT("r.%d.%d.region"), RegionCoordinates.X, RegionCoordinates.Y);
+	LoadRegionTable(*Region);
+	return *Region;
+}
+
+void FChunkRegionStore::LoadRegionTable(FRegion& Region) const
+{
+	Region.Entries.SetNumZeroed(RegionSize * RegionSize);
+	static_assert(sizeof(FRegionEntry) == 2 * sizeof(uint32), "Entries are written as they are laid out");
+
+	const int64 FileSize = FPlatformFileManager::Get().GetPlatformFile().FileSize(*Region.Path);
+	if (FileSize < 0) return;
+
+	Region.FileSize = FileSize;
+	uint32 Header[2] = { 0, 0 };
+	if (FileSize >= GetRegionHeaderSize() && MapRegion(Region))
+	{
+		const uint8* Data = Region.MappedRegion->GetMappedPtr();
+		FMemory::Memcpy(Header, Data, sizeof(Header));
+		if (Header[0] == RegionMagic && Header[1] == RegionVersion)
+		{
+			FMemory::Memcpy(Region.Entries.GetData(), Data + sizeof(Header), Region.Entries.Num() * sizeof(FRegionEntry));
+		}
+	}
+
+	bool bValid = Header[0] == RegionMagic && Header[1] == RegionVersion;
+	for (const FRegionEntry& Entry : Region.Entries)
+	{
+		bValid &= static_cast<int64>(Entry.Edits.Offset) + Entry.Edits.Size <= FileSize;
+		Region.LiveBytes += Entry.Edits.Size;
+	}
+
+	if (!bValid)
+	{
+		// Kept aside rather than overwritten, and the region starts over empty
+		UE_LOG(LogTemp, Warning, TEXT("Chunk region %s is not a valid region file, moving it aside"), *Region.Path);
+		UnmapRegion(Region);
+		IFileManager::Get().Move(*(Region.Path + TEXT(".bad")), *Region.Path, true, true);
+		FMemory::Memzero(Region.Entries.GetData(), Region.Entries.Num() * sizeof(FRegionEntry));
+		Region.FileSize = 0;
+		Region.LiveBytes = 0;
+	}
+}
+
+bool FChunkRegionStore::MapRegion(FRegion& Region) const
+{
+	if (Region.MappedRegion) return true;
+	if (Region.FileSize <= 0) return false;
+
+	IPlatformFile::FOpenMappedResult Result = FPlatformFileManager::Get().GetPlatformFile().OpenMappedEx(*Region.Path);
+	if (Result.HasError()) return false;
+
+	Region.MappedFile = Result.StealValue();
+	Region.MappedRegion.Reset(Region.MappedFile->MapRegion(0, Region.FileSize));
+	if (!Region.MappedRegion)
+	{
+		Region.MappedFile.Reset();
+		return false;
+	}
+	return true;
+}
+
+void FChunkRegionStore::UnmapRegion(FRegion& Region) const
+{
+	// The region must go before the file it maps
+	Region.MappedRegion.Reset();
+	Region.MappedFile.Reset();
+}
+
+void FChunkRegionStore::WriteRecords(const FIntVector2& RegionCoordinates, TArray<FChunkRecordWrite>& Records)
+{
+	FRegion& Region = GetRegion(RegionCoordinates);
+	UnmapRegion(Region);
+
+	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	PlatformFile.CreateDirectoryTree(*Directory);
+
+	TUniquePtr<IFileHandle> File(PlatformFile.OpenWrite(*Region.Path, true, true));
+	if (!File)
+	{
+		UE_LOG(LogTemp, Error, TEXT("Could not open chunk region %s for writing, %d chunks not saved"), *Region.Path, Records.Num());
+		return;
+	}
+
+	const int64 HeaderSize = GetRegionHeaderSize();
+	if (Region.FileSize < HeaderSize)
+	{
+		const uint32 Header[2] = { RegionMagic, RegionVersion };
+		File->Seek(0);
+		File->Write(reinterpret_cast<const uint8*>(Header), sizeof(Header));
+		File->Write(reinterpret_cast<const uint8*>(Region.Entries.GetData()), Region.Entries.Num() * sizeof(FRegionEntry));
+		Region.FileSize = HeaderSize;
+	}
+
+	for (FChunkRecordWrite& Record : Records)
+	{
+		FRegionEntry& Entry = Region.Entries[GetEntryIndex(Record.ChunkCoordinates)];
+		ScratchBuffer.Reset();
+		FMemoryWriter Writer(ScratchBuffer);
+		Writer << Record.Edits;
+		AppendPayload(*File, Region, Entry.Edits);
+	}
+
+	// The table goes last, so a write cut short leaves the old entries pointing at old, intact payloads
+	File->Seek(2 * sizeof(uint32));
+	File->Write(reinterpret_cast<const uint8*>(Region.Entries.GetData()), Region.Entries.Num() * sizeof(FRegionEntry));
+	File->Flush();
+	File.Reset();
+
+	CompactIfNeeded(Region);
+}
+
+bool FChunkRegionStore::AppendPayload(IFileHandle& File, FRegion& Region, FRegionPayload& Payload)
+{
+	const uint32 RawSize = ScratchBuffer.Num();
+	int32 CompressedSize = FCompression::GetMaximumCompressedSize(PayloadCompression, RawSize);
+
+	TArray<uint8> Compressed;
+	Compressed.SetNumUninitialized(sizeof(uint32) + CompressedSize);
+	FMemory::Memcpy(Compressed.GetData(), &RawSize, sizeof(uint32));
+	if (!FCompression::CompressMemory(PayloadCompression, Compressed.GetData() + sizeof(uint32), CompressedSize, ScratchBuffer.GetData(), RawSize))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Could not compress a chunk record for %s, not saved"), *Region.Path);
+		return false;
+	}
+
+	const int64 Offset = Region.FileSize;
+	const uint32 PayloadSize = sizeof(uint32) + CompressedSize;
+	File.Seek(Offset);
+	if (!File.Write(Compressed.GetData(), PayloadSize))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Could not write a chunk record to %s"), *Region.Path);
+		return false;
+	}
+
+	Region.LiveBytes += static_cast<int64>(PayloadSize) - Payload.Size;
+	Payload.Offset = static_cast<uint32>(Offset);
+	Payload.Size = PayloadSize;
+	Region.FileSize = Offset + PayloadSize;
+	return true;
+}
+
+void FChunkRegionStore::ReadRecord(const FIntVector2& ChunkCoordinates, FChunkRecordRead& OutRecord)
+{
+	FRegion& Region = GetRegion(GetRegionCoordinates(ChunkCoordinates));
+	const FRegionEntry Entry = Region.Entries[GetEntryIndex(ChunkCoordinates)];
+	if (Entry.Edits.Size == 0) return;
+
+	OutRecord.bFound = true;
+
+	if (ReadPayload(Region, Entry.Edits))
+	{
+		FMemoryReader Reader(ScratchBuffer);
+		Reader << OutRecord.Edits;
+		if (Reader.IsError())
+		{
+			UE_LOG(LogTemp, Error, TEXT("Edits to chunk (%d, %d) in %s are corrupt, not loaded"), ChunkCoordinates.X, ChunkCoordinates.Y, *Region.Path);
+		}
+	}
+}
+
+bool FChunkRegionStore::ReadPayload(FRegion& Region, const FRegionPayload& Payload)
+{
+	if (Payload.Size <= sizeof(uint32)) return false;
+
+	if (!MapRegion(Region))
+	{
+		UE_LOG(LogTemp, Error, TEXT("Could not map chunk region %s"), *Region.Path);
+		return false;
+	}
+
+	// Decompressed straight out of the mapping; the compressed bytes are never copied
+	const uint8* Data = Region.MappedRegion->GetMappedPtr() + Payload.Offset;
+	uint32 RawSize = 0;
+	FMemory::Memcpy(&RawSize, Data, sizeof(uint32));
+
+	ScratchBuffer.SetNumUninitialized(RawSize);
+	if (!FCompression::UncompressMemory(PayloadCompression, ScratchBuffer.GetData(), RawSize, Data + sizeof(uint32), Payload.Size - sizeof(uint32)))
+	{
+		UE_LOG(LogTemp, Error, TEXT("A chunk record in %s is corrupt, not loaded"), *Region.Path);
+		return false;
+	}
+	return true;
+}
+
+void FChunkRegionStore::CompactIfNeeded(FRegion& Region)
+{
+	const int64 HeaderSize = GetRegionHeaderSize();
+	const int64 DeadBytes = Region.FileSize - HeaderSize - Region.LiveBytes;
+	if (DeadBytes < MinCompactionBytes || DeadBytes < Region.LiveBytes) return;
+	if (!MapRegion(Region)) return;
+
+	TArray<FRegionEntry> Entries = Region.Entries;
+	TArray<uint8> Bytes;
+	Bytes.SetNumUninitialized(HeaderSize);
+	Bytes.Reserve(HeaderSize + Region.LiveBytes);
+
+	const uint8* Data = Region.MappedRegion->GetMappedPtr();
+	for (FRegionEntry& Entry : Entries)
+	{
+		if (Entry.Edits.Size == 0) continue;
+
+		const int64 NewOffset = Bytes.Num();
+		Bytes.Append(Data + Entry.Edits.Offset, Entry.Edits.Size);
+		Entry.Edits.Offset = static_cast<uint32>(NewOffset);
+	}
+
+	const uint32 Header[2] = { RegionMagic, RegionVersion };
+	FMemory::Memcpy(Bytes.GetData(), Header, sizeof(Header));
+	FMemory::Memcpy(Bytes.GetData() + sizeof(Header), Entries.GetData(), Entries.Num() * sizeof(FRegionEntry));
+
+	UnmapRegion(Region);
+
+	// Written beside the region and moved over it, so the old file stays whole until the new one is
+	const FString TempPath = Region.Path + TEXT(".tmp");
+	if (!FFileHelper::SaveArrayToFile(Bytes, *TempPath) || !IFileManager::Get().Move(*Region.Path, *TempPath, true, true))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("Could not compact chunk region %s"), *Region.Path);
+		IFileManager::Get().Delete(*TempPath, false, false, true);
+		return;
+	}
+
+	Region.Entries = MoveTemp(Entries);
+	Region.FileSize = Bytes.Num();
+}
@@ -5,7 +5,9 @@
 
 #include "Components/HierarchicalInstancedStaticMeshComponent.h"
 #include "Structs/BiomeSettings.h"
-#include "Structs/ChunkColumn.h"
+#include "Structs/ChunkVoxels.h"
+#include "Structs/FoliageStamps.h"
+#include "Structs/StructurePlacement.h"
 
 UFoliageGenerator::UFoliageGenerator()
 {
@@ -16,87 +18,171 @@ int GetColumnIndex(int LocalX, int LocalY, int ChunkSize)
     return LocalX + (LocalY * ChunkSize);
 }
 
-bool UFoliageGenerator::AttemptPlaceFoliageAt(TArray<FChunkColumn>& ChunkColumnsData, int LocalX, int LocalY,
-    const FBiomeSettings* BiomeInfo, const FRandomStream& ColumnSpecificStream, int ChunkSize, int ChunkHeight)
+bool UFoliageGenerator::AttemptPlaceFoliageAt(FStructureWriter& Writer, int LocalX, int LocalY,
+    const FCompiledBiome* BiomeInfo, const FRandomStream& ColumnSpecificStream, const FFoliageStampLibrary* Stamps)
 {
-    if (!BiomeInfo) return false;
+    if (!BiomeInfo || !Writer.IsInsideChunk(LocalX, LocalY)) return false;
 
-    int ColumnIndex = GetColumnIndex(LocalX, LocalY, ChunkSize);
-    if (ColumnIndex < 0 || ColumnIndex >= ChunkColumnsData.Num()) return false;
-    
-    FChunkColumn& CurrentColumn = ChunkColumnsData[ColumnIndex];
+    if (RollFoliageRulesAt(Writer, LocalX, LocalY, Writer.GetSite(LocalX, LocalY), BiomeInfo, ColumnSpecificStream, Stamps))
+    {
+        return true;
+    }
 
-    int TopSolidZ = CurrentColumn.Height;
-    if (TopSolidZ < 0 || TopSolidZ >= ChunkHeight - 1) return false;
+    // If no major foliage was placed, try to place surface grass
+    AttemptPlaceGrassAt(Writer, LocalX, LocalY, BiomeInfo, ColumnSpecificStream);
+    // No major foliage placed
+    return false;
+}
 
-    EBlock SurfaceBlock = CurrentColumn.Blocks[TopSolidZ];
-    int SpawnZ = TopSolidZ + 1;
+bool UFoliageGenerator::RollFoliageRulesAt(FStructureWriter& Writer, int LocalX, int LocalY, const FStructureSite& Site,
+    const FCompiledBiome* BiomeInfo, const FRandomStream& ColumnSpecificStream, const FFoliageStampLibrary* Stamps)
+{
+    if (!BiomeInfo) return false;
+    if (Site.TopSolidZ < 0 || Site.TopSolidZ >= Writer.GetChunkHeight() - 1) return false;
+
+    const uint32 SurfaceMask = GetBlockMask(Site.SurfaceBlock);
 
     // Try to place major foliage (trees, cactus)
-    for (const FFoliageSpawnRule& Rule : BiomeInfo->FoliageRules)
+    for (const FCompiledFoliageRule& Rule : BiomeInfo->FoliageRules)
     {
-        if (!Rule.AllowedSurfaceBlocks.Contains(SurfaceBlock)) continue;
+        if (!(Rule.SurfaceMask & SurfaceMask)) continue;
         
-        if (ColumnSpecificStream.FRand() < Rule.SpawnChancePerColumn)
+        if (ColumnSpecificStream.FRand() < Rule.SpawnThreshold)
         {
-             // Check if spawn spot in this column is clear
-            if (SpawnZ < ChunkHeight && CurrentColumn.Blocks[SpawnZ] == EBlock::Air)
+            // Create a new stream for the specific tree's internal variations, mixing in type for variety
+            FRandomStream FoliageInstanceStream(ColumnSpecificStream.GetCurrentSeed() ^ (int32)Rule.Type);
+            if (PlaceFoliageRuleAt(Writer, LocalX, LocalY, Site, Rule, FoliageInstanceStream, Stamps))
             {
-                // Create a new stream for the specific tree's internal variations
-                FRandomStream FoliageInstanceStream;
-                // Mix in type for variety
-                FoliageInstanceStream.Initialize(ColumnSpecificStream.GetCurrentSeed() ^ (int32)Rule.Type); 
-
-                int FoliageHeight = FoliageInstanceStream.RandRange(Rule.MinHeight, Rule.MaxHeight);
-                bool bIsVariant = FoliageInstanceStream.FRand() < Rule.VariantChance;
-                
-                FIntVector FoliageBaseLocalPos(LocalX, LocalY, SpawnZ);
-
-                // Basic vertical fit check
-                if (SpawnZ + FoliageHeight + 3 >= ChunkHeight) {
-                    FoliageHeight = ChunkHeight - SpawnZ - 4;
-                    if (FoliageHeight < Rule.MinHeight && Rule.Type != EFoliageType::GrassPlant) continue;
-                }
-                if (FoliageHeight < 1 && Rule.Type == EFoliageType::GrassPlant) continue;
-
-
-                switch (Rule.Type)
-                {
-                    case EFoliageType::OakTree:
-                        GenerateOakTree(ChunkColumnsData, FoliageBaseLocalPos, FoliageHeight, bIsVariant, FoliageInstanceStream, ChunkSize, ChunkHeight);
-                        return true;
-                    case EFoliageType::BirchTree:
-                        GenerateBirchTree(ChunkColumnsData, FoliageBaseLocalPos, FoliageHeight, bIsVariant, FoliageInstanceStream, ChunkSize, ChunkHeight);
-                        return true;
-                    case EFoliageType::Cactus:
-                        GenerateCactus(ChunkColumnsData, FoliageBaseLocalPos, FoliageHeight, FoliageInstanceStream, ChunkSize, ChunkHeight);
-                        return true;
-                    case EFoliageType::GrassPlant:
-                        break;
-                }
+                return true;
             }
         }
-        
     }
+    return false;
+}
 
-    // If no major foliage was placed, try to place surface grass
-    if (BiomeInfo->SurfaceGrassChance > 0 && BiomeInfo->GrassSpawnableOn.Contains(SurfaceBlock))
+bool UFoliageGenerator::PlaceFoliageRuleAt(FStructureWriter& Writer, int LocalX, int LocalY, const FStructureSite& Site,
+    const FCompiledFoliageRule& Rule, FRandomStream& FoliageInstanceStream, const FFoliageStampLibrary* Stamps)
+{
+    const int ChunkHeight = Writer.GetChunkHeight();
+    const int SpawnZ = Site.TopSolidZ + 1;
+
+    // Check if spawn spot in this column is clear
+    if (SpawnZ < 1 || SpawnZ >= ChunkHeight || Site.SpawnBlock != EBlock::Air) return false;
+
+    int FoliageHeight = FoliageInstanceStream.RandRange(Rule.MinHeight, Rule.MaxHeight);
+    bool bIsVariant = FoliageInstanceStream.FRand() < Rule.VariantThreshold;
+
+    FIntVector FoliageBaseLocalPos(LocalX, LocalY, SpawnZ);
+
+    // Basic vertical fit check
+    if (SpawnZ + FoliageHeight + 3 >= ChunkHeight) {
+        FoliageHeight = ChunkHeight - SpawnZ - 4;
+        if (FoliageHeight < Rule.MinHeight && Rule.Type != EFoliageType::GrassPlant) return false;
+    }
+    if (FoliageHeight < 1 && Rule.Type == EFoliageType::GrassPlant) return false;
+
+    // Prebaked shape picked by the tree's own stream, clipped at the world's ceiling like the generators
+    if (const FFoliageStamp* Stamp = Stamps ? Stamps->Find(Rule.Type, FoliageHeight, bIsVariant, FoliageInstanceStream.GetUnsignedInt()) : nullptr)
+    {
+        Stamp->Place(Writer, FoliageBaseLocalPos);
+        return true;
+    }
+
+    switch (Rule.Type)
     {
-        if (ColumnSpecificStream.FRand() < BiomeInfo->SurfaceGrassChance)
+        case EFoliageType::OakTree:
+            GenerateOakTree(Writer, FoliageBaseLocalPos, FoliageHeight, bIsVariant, FoliageInstanceStream);
+            return true;
+        case EFoliageType::BirchTree:
+            GenerateBirchTree(Writer, FoliageBaseLocalPos, FoliageHeight, bIsVariant, FoliageInstanceStream);
+            return true;
+        case EFoliageType::Cactus:
+            GenerateCactus(Writer, FoliageBaseLocalPos, FoliageHeight, FoliageInstanceStream);
+            return true;
+        case EFoliageType::GrassPlant:
+            break;
+    }
+    return false;
+}
+
+bool UFoliageGenerator::AttemptPlaceGrassAt(FStructureWriter& Writer, int LocalX, int LocalY,
+    const FCompiledBiome* BiomeInfo, const FRandomStream& ColumnSpecificStream)
+{
+    if (!BiomeInfo) return false;
+
+    FChunkVoxels& Voxels = Writer.GetVoxels();
+    const int ChunkSize = Writer.GetChunkSize();
+    const int ChunkHeight = Writer.GetChunkHeight();
+
+    const int ColumnIndex = GetColumnIndex(LocalX, LocalY, ChunkSize);
+    if (ColumnIndex < 0 || ColumnIndex >= Voxels.NumColumns()) return false;
+
+    const TArrayView<EBlock> ColumnBlocks = Voxels.GetColumnBlocks(ColumnIndex);
+    const int TopSolidZ = Voxels.Columns[ColumnIndex].Height;
+    if (TopSolidZ < 0 || TopSolidZ >= ChunkHeight - 1) return false;
+    if (!(BiomeInfo->GrassSurfaceMask & GetBlockMask(ColumnBlocks[TopSolidZ]))) return false;
+
+    const int SpawnZ = TopSolidZ + 1;
+    if (ColumnSpecificStream.FRand() < BiomeInfo->GrassThreshold && ColumnBlocks[SpawnZ] == EBlock::Air)
+    {
+        GenerateGrass(ColumnBlocks, SpawnZ, ChunkHeight);
+        return true;
+    }
+    return false;
+}
+
+void UFoliageGenerator::BakeStamp(EFoliageType Type, int Height, bool bLargeVariant, FRandomStream& Stream, FFoliageStamp& OutStamp)
+{
+    OutStamp.Spans.Reset();
+    OutStamp.Height = 0;
+
+    // The headroom keeps every generator's ceiling check out of the way
+    constexpr int BoxRadius = MaxStructureReach;
+    constexpr int BoxSize = BoxRadius * 2 + 1;
+    const int BoxHeight = Height + 16;
+
+    FChunkVoxels Box(BoxSize, BoxHeight);
+    FStructureWriter Writer(Box);
+    const FIntVector Base(BoxRadius, BoxRadius, 0);
+    switch (Type)
+    {
+        case EFoliageType::OakTree:
+            GenerateOakTree(Writer, Base, Height, bLargeVariant, Stream);
+            break;
+        case EFoliageType::BirchTree:
+            GenerateBirchTree(Writer, Base, Height, bLargeVariant, Stream);
+            break;
+        case EFoliageType::Cactus:
+            GenerateCactus(Writer, Base, Height, Stream);
+            break;
+        case EFoliageType::GrassPlant:
+            return;
+    }
+
+    for (int y = 0; y < BoxSize; ++y)
+    {
+        for (int x = 0; x < BoxSize; ++x)
         {
-            if (SpawnZ < ChunkHeight && CurrentColumn.Blocks[SpawnZ] == EBlock::Air)
+            const TArrayView<const EBlock> Blocks = Box.GetColumnBlocks(GetColumnIndex(x, y, BoxSize));
+            int z = 0;
+            while (z < BoxHeight)
             {
-                GenerateGrass(CurrentColumn.Blocks, SpawnZ, ChunkHeight);
+                const EBlock Block = Blocks[z];
+                const int Start = z;
+                while (z < BoxHeight && Blocks[z] == Block) ++z;
+                if (Block == EBlock::Air) continue;
+
+                OutStamp.Spans.Add({ x - BoxRadius, y - BoxRadius, Start, z - Start, Block });
+                OutStamp.Height = FMath::Max(OutStamp.Height, z);
             }
         }
     }
-    // No major foliage placed
-    return false;
 }
 
-void UFoliageGenerator::GenerateOakTree(TArray<FChunkColumn>& ChunkColumnsData, const FIntVector& TreeBaseLocalPosInChunk,
-    int FoliageHeight, bool bLargeVariant, FRandomStream& Stream, int ChunkSize, int ChunkHeight)
+void UFoliageGenerator::GenerateOakTree(FStructureWriter& Writer, const FIntVector& TreeBaseLocalPosInChunk,
+    int FoliageHeight, bool bLargeVariant, FRandomStream& Stream)
 {
+    const int ChunkHeight = Writer.GetChunkHeight();
     int TrunkX = TreeBaseLocalPosInChunk.X;
     int TrunkY = TreeBaseLocalPosInChunk.Y;
     int BaseZ = TreeBaseLocalPosInChunk.Z;
@@ -107,7 +193,7 @@ void UFoliageGenerator::GenerateOakTree(TArray<FChunkColumn>& ChunkColumnsData,
     // Trunk
     for (int i = 0; i < FoliageHeight; ++i)
     {
-        SetBlockInChunkColumns(ChunkColumnsData, TrunkX, TrunkY, BaseZ + i, EBlock::OakLog, ChunkSize, ChunkHeight);
+        Writer.SetBlock(TrunkX, TrunkY, BaseZ + i, EBlock::OakLog);
     }
 
     // Canopy (More spherical/rounded)
@@ -144,23 +230,24 @@ void UFoliageGenerator::GenerateOakTree(TArray<FChunkColumn>& ChunkColumnsData,
                     if (CurrentLeafZ >= BaseZ + FoliageHeight -1 && RelX == 0 && RelY == 0 && CurrentLayerHRadius > 0)
                     {
                         // If it's the center point above the trunk, ensure it's leaves
-                         SetBlockInChunkColumns(ChunkColumnsData, TrunkX + RelX, TrunkY + RelY, CurrentLeafZ, EBlock::OakLeaves, ChunkSize, ChunkHeight);
+                         Writer.SetBlock(TrunkX + RelX, TrunkY + RelY, CurrentLeafZ, EBlock::OakLeaves);
                         continue;
                     }
                     
                     // Random chance to skip some inner blocks for a less solid look
                     if (DistSq < FMath::Square(CurrentLayerHRadius - 0.5f) && Stream.FRand() < 0.2f && CurrentLayerHRadius > 1) continue;
 
-                    SetBlockInChunkColumns(ChunkColumnsData, TrunkX + RelX, TrunkY + RelY, CurrentLeafZ, EBlock::OakLeaves, ChunkSize, ChunkHeight);
+                    Writer.SetBlock(TrunkX + RelX, TrunkY + RelY, CurrentLeafZ, EBlock::OakLeaves);
                 }
             }
         }
     }
 }
 
-void UFoliageGenerator::GenerateBirchTree(TArray<FChunkColumn>& ChunkColumnsData, const FIntVector& TreeBaseLocalPosInChunk,
-    int FoliageHeight, bool bLargeVariant, FRandomStream& Stream, int ChunkSize, int ChunkHeight)
+void UFoliageGenerator::GenerateBirchTree(FStructureWriter& Writer, const FIntVector& TreeBaseLocalPosInChunk,
+    int FoliageHeight, bool bLargeVariant, FRandomStream& Stream)
 {
+    const int ChunkHeight = Writer.GetChunkHeight();
     int TrunkX = TreeBaseLocalPosInChunk.X;
     int TrunkY = TreeBaseLocalPosInChunk.Y;
     int BaseZ = TreeBaseLocalPosInChunk.Z;
@@ -171,7 +258,7 @@ void UFoliageGenerator::GenerateBirchTree(TArray<FChunkColumn>& ChunkColumnsData
     // Trunk
     for (int i = 0; i < ActualHeight; ++i)
     {
-        SetBlockInChunkColumns(ChunkColumnsData, TrunkX, TrunkY, BaseZ + i, EBlock::BirchLog, ChunkSize, ChunkHeight);
+        Writer.SetBlock(TrunkX, TrunkY, BaseZ + i, EBlock::BirchLog);
     }
 
     // Birch Canopy (Taller, more "fluffy" or sparse, less perfectly round)
@@ -208,7 +295,7 @@ void UFoliageGenerator::GenerateBirchTree(TArray<FChunkColumn>& ChunkColumnsData
                     // Random chance to make it sparser
                     if (Stream.FRand() < 0.85f) // 85% chance to place a leaf if in range
                     {
-                       SetBlockInChunkColumns(ChunkColumnsData, TrunkX + RelX, TrunkY + RelY, CurrentLeafZ, EBlock::BirchLeaves, ChunkSize, ChunkHeight);
+                       Writer.SetBlock(TrunkX + RelX, TrunkY + RelY, CurrentLeafZ, EBlock::BirchLeaves);
                     }
                 }
             }
@@ -216,9 +303,10 @@ void UFoliageGenerator::GenerateBirchTree(TArray<FChunkColumn>& ChunkColumnsData
     }
 }
 
-void UFoliageGenerator::GenerateCactus(TArray<FChunkColumn>& ChunkColumnsData, const FIntVector& CactusBaseLocalPosInChunk,
-    int FoliageHeight, FRandomStream& Stream, int ChunkSize, int ChunkHeight)
+void UFoliageGenerator::GenerateCactus(FStructureWriter& Writer, const FIntVector& CactusBaseLocalPosInChunk,
+    int FoliageHeight, FRandomStream& Stream)
 {
+    const int ChunkHeight = Writer.GetChunkHeight();
     int TrunkX = CactusBaseLocalPosInChunk.X;
     int TrunkY = CactusBaseLocalPosInChunk.Y;
     int BaseZ = CactusBaseLocalPosInChunk.Z;
@@ -228,7 +316,7 @@ void UFoliageGenerator::GenerateCactus(TArray<FChunkColumn>& ChunkColumnsData, c
     // Main Trunk
     for (int i = 0; i < FoliageHeight; ++i)
     {
-        SetBlockInChunkColumns(ChunkColumnsData, TrunkX, TrunkY, BaseZ + i, EBlock::CactusBlock, ChunkSize, ChunkHeight);
+        Writer.SetBlock(TrunkX, TrunkY, BaseZ + i, EBlock::CactusBlock);
     }
 
     // Only add arms if trunk is tall enough
@@ -254,54 +342,27 @@ void UFoliageGenerator::GenerateCactus(TArray<FChunkColumn>& ChunkColumnsData, c
             if (ArmDirection == 0) ArmX++; else if (ArmDirection == 1) ArmX--;
             else if (ArmDirection == 2) ArmY++; else if (ArmDirection == 3) ArmY--;
 
-            // Check if space for arm base is clear (not another cactus block from trunk or previous arm)
-            // This requires checking ChunkColumnsData at (ArmX, ArmY, ArmBaseZ)
-            if (ArmX >= 0 && ArmX < ChunkSize && ArmY >= 0 && ArmY < ChunkSize && ArmBaseZ < ChunkHeight) {
-                int CheckColumnIndex = GetColumnIndex(ArmX, ArmY, ChunkSize);
-                 if (CheckColumnIndex < ChunkColumnsData.Num() && ChunkColumnsData[CheckColumnIndex].Blocks[ArmBaseZ] != EBlock::Air) {
-                     // Space for arm base is not clear
-                     continue;
-                 }
-            } else {
-                // Arm base out of chunk bounds
+            // Check if space for arm base is clear (not another cactus block from trunk or previous arm).
+            // Arms reaching into a neighbouring chunk can't be checked here; they only ever fill air there.
+            if (ArmBaseZ >= ChunkHeight || Writer.GetBlock(ArmX, ArmY, ArmBaseZ) != EBlock::Air)
+            {
                 continue;
             }
 
-
             for (int h = 0; h < ArmHeight; ++h)
             {
-                SetBlockInChunkColumns(ChunkColumnsData, ArmX, ArmY, ArmBaseZ + h, EBlock::CactusBlock, ChunkSize, ChunkHeight);
+                Writer.SetBlock(ArmX, ArmY, ArmBaseZ + h, EBlock::CactusBlock);
             }
         }
     }
 }
 
-void UFoliageGenerator::GenerateGrass(TArray<EBlock>& Blocks, int BaseZ, int ChunkHeight)
+void UFoliageGenerator::GenerateGrass(TArrayView<EBlock> Blocks, int BaseZ, int ChunkHeight)
 {
     SetBlockInSingleColumnArray(Blocks, BaseZ, EBlock::GrassFoliage, ChunkHeight);
 }
 
-void UFoliageGenerator::SetBlockInChunkColumns(TArray<FChunkColumn>& ChunkColumnsData, int LocalX, int LocalY,
-    int LocalZ, EBlock BlockType, int ChunkSize, int ChunkHeight) const
-{
-    if (LocalX >= 0 && LocalX < ChunkSize &&
-        LocalY >= 0 && LocalY < ChunkSize &&
-        LocalZ >= 0 && LocalZ < ChunkHeight)
-    {
-        int ColumnIndex = GetColumnIndex(LocalX, LocalY, ChunkSize);
-
-        if (ColumnIndex < 0 || ColumnIndex >= ChunkColumnsData.Num()) return;
-        
-        if (LocalZ < 0 || LocalZ >= ChunkColumnsData[ColumnIndex].Blocks.Num()) return;
-
-        if (ChunkColumnsData[ColumnIndex].Blocks[LocalZ] == EBlock::Air)
-        {
-            ChunkColumnsData[ColumnIndex].Blocks[LocalZ] = BlockType;
-        }
-    }
-}
-
-void UFoliageGenerator::SetBlockInSingleColumnArray(TArray<EBlock>& Blocks, int Z, EBlock BlockType, int ChunkHeight) const
+void UFoliageGenerator::SetBlockInSingleColumnArray(TArrayView<EBlock> Blocks, int Z, EBlock BlockType, int ChunkHeight)
 {
     if (Z >= 0 && Z < ChunkHeight)
     {
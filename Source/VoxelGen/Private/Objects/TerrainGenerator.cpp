@@ -1,41 +1,34 @@
 ﻿#include "Objects/TerrainGenerator.h"
-#include "FastNoiseWrapper.h"
 #include "Actors/ChunkWorld.h"
 #include "Structs/ChunkColumn.h"
 #include "Structs/ChunkData.h"
 #include "Engine/DataTable.h"
 #include "Math/UnrealMathUtility.h"
-#include "Objects/FoliageGenerator.h"
 #include "Curves/CurveFloat.h" // Include for UCurveFloat
 #include "Structs/NoiseGenerationPreset.h"
 
 UTerrainGenerator::UTerrainGenerator()
 {
 	PrimaryComponentTick.bCanEverTick = false;
-	FoliageGenerator = CreateDefaultSubobject<UFoliageGenerator>("FoliageGenerator");
+	GenerationStats = MakeShared<FTerrainGenerationStats, ESPMode::ThreadSafe>();
 }
 
-void UTerrainGenerator::UpdateSeed(int32 NewSeed) const
+void UTerrainGenerator::UpdateSeed(int32 NewSeed)
 {
-	ContinentalnessNoise->SetSeed(NewSeed);
-	ErosionNoise->SetSeed(NewSeed);
-	WeirdnessNoise->SetSeed(NewSeed);
-	TemperatureNoise->SetSeed(NewSeed);
-	HumidityNoise->SetSeed(NewSeed);
+	CachedSeed = NewSeed;
+
+	// Tasks started with the old seed finish on their own snapshot
+	if (bNoiseInitialized)
+	{
+		RebuildState();
+	}
 }
 
 void UTerrainGenerator::SetNoisePreset(UNoiseGenerationPreset* NewPreset)
 {
     if (NewPreset && NewPreset != NoiseGenerationPreset)
     {
-        // Clean up existing noise objects
-        ContinentalnessNoise = nullptr;
-        ErosionNoise = nullptr;
-        WeirdnessNoise = nullptr;
-        TemperatureNoise = nullptr;
-        HumidityNoise = nullptr;
-
-        // Set the new preset and reinitialize noise
+        // Set the new preset and rebuild the snapshot
         NoiseGenerationPreset = NewPreset;
         InitializeNoise();
     }
@@ -68,260 +61,268 @@ void UTerrainGenerator::InitializeNoise()
     {
         return;
     }
-	SetupNoise(ContinentalnessNoise, NoiseGenerationPreset->Continentalness);
-	SetupNoise(ErosionNoise, NoiseGenerationPreset->Erosion);
-	SetupNoise(WeirdnessNoise, NoiseGenerationPreset->Weirdness);
-	SetupNoise(TemperatureNoise, NoiseGenerationPreset->Temperature);
-	SetupNoise(HumidityNoise, NoiseGenerationPreset->Humidity);
+
+    // Cached so generation never has to reach the game instance from a worker thread
+    CachedSeed = ParentWorld->Seed;
+    CachedChunkSize = FChunkData::GetChunkSize(this);
+    CachedChunkHeight = FChunkData::GetChunkHeight(this);
+
+    InitializeGeneration();
 }
 
-// SetupNoise remains the same as before
-void UTerrainGenerator::SetupNoise(TObjectPtr<UFastNoiseWrapper>& Noise, const UNoiseOctaveSettingsAsset* Settings)
+void UTerrainGenerator::InitializeStandalone(int32 InSeed, int32 InChunkSize, int32 InChunkHeight)
 {
-	if (!Settings || !ParentWorld) return;
-	if (!Noise)
-	{
-		Noise = NewObject<UFastNoiseWrapper>(this);
-	}
-    
-	Noise->SetupFastNoise(
-		Settings->NoiseType,
-		ParentWorld->Seed + Settings->SeedOffset,
-		Settings->Frequency,
-		Settings->Interpolation,
-		Settings->FractalType,
-		Settings->Octaves,
-		Settings->Lacunarity,
-		Settings->Gain
-	);
+    if (!NoiseGenerationPreset)
+    {
+        UE_LOG(LogTemp, Error, TEXT("UTerrainGenerator: InitializeStandalone needs a NoiseGenerationPreset."));
+        return;
+    }
+
+    CachedSeed = InSeed;
+    CachedChunkSize = InChunkSize;
+    CachedChunkHeight = InChunkHeight;
+
+    InitializeGeneration();
+    bNoiseInitialized = true;
 }
 
-FChunkColumn UTerrainGenerator::GenerateColumnData(int GlobalX, int GlobalY)
+void UTerrainGenerator::InitializeGeneration()
 {
-	const int ChunkHeight = FChunkData::GetChunkHeight(this); // Get chunk height config
-	FChunkColumn Column(ChunkHeight, GlobalX, GlobalY); // Create column structure
+	BakeSplineLUTs();
+	BuildBiomeClassifier();
 
-	if (!bNoiseInitialized)
+	if (CompiledBiomesSource.Get() != BiomesTable.Get() || !CompiledBiomes)
 	{
-		UE_LOG(LogTemp, Error, TEXT("GenerateColumnData called before noise was initialized for (%d, %d)!"), GlobalX, GlobalY);
-		// Optionally return a default column (e.g., all stone)
-        for (int z = 0; z < ChunkHeight; ++z) Column.Blocks[z] = EBlock::Stone;
-        Column.Height = FMath::Clamp(FMath::RoundToInt(TerrainBaseHeight), 0, ChunkHeight - 1);
-		return Column;
+		CompileBiomeTable();
 	}
-	
-    float RawCont = ContinentalnessNoise ? ContinentalnessNoise->GetNoise2D(GlobalX, GlobalY) : 0.f;
-	float RawErosion = ErosionNoise ? ErosionNoise->GetNoise2D(GlobalX, GlobalY) : 0.f;
-	float RawWeirdness = WeirdnessNoise ? WeirdnessNoise->GetNoise2D(GlobalX, GlobalY) : 0.f;
-    float PV_neg1_1 = 1.0f - FMath::Abs((3.0f * FMath::Abs(RawWeirdness)) - 2.0f);
-	float PV01_forSpline = (PV_neg1_1 + 1.f) / 2.f;
 
-    // Normalize raw noises to [0, 1] for spline input
-	float Cont01 = (RawCont + 1.f) / 2.f;
-	float Ero01 = (RawErosion + 1.f) / 2.f;
-	float Weird01 = (RawWeirdness + 1.f) / 2.f;
+	RebuildState();
+}
+
+void UTerrainGenerator::RebuildState()
+{
+	if (!NoiseGenerationPreset)
+	{
+		UE_LOG(LogTemp, Error, TEXT("UTerrainGenerator: No NoiseGenerationPreset, generation snapshot not built."));
+		return;
+	}
 
-    float SplinedContinentalness, SplinedErosion, SplinedWeirdness, SplinedPeaksValleys;
-    ApplySpline(ContinentalnessSpline, Cont01, SplinedContinentalness);
-	ApplySpline(ErosionSpline, Ero01, SplinedErosion);
-	ApplySpline(WeirdnessSpline, Weird01, SplinedWeirdness);
-    ApplySpline(PeaksValleysSpline, PV01_forSpline, SplinedPeaksValleys);
+	TSharedPtr<FTerrainGeneratorState, ESPMode::ThreadSafe> NewState = MakeShared<FTerrainGeneratorState, ESPMode::ThreadSafe>();
+	NewState->Seed = CachedSeed;
+	NewState->ChunkSize = CachedChunkSize;
+	NewState->ChunkHeight = CachedChunkHeight;
+
+	SetupNoiseSource(NewState->ContinentalnessNoise, NoiseGenerationPreset->Continentalness, true, TEXT("Continentalness"));
+	SetupNoiseSource(NewState->ErosionNoise, NoiseGenerationPreset->Erosion, true, TEXT("Erosion"));
+	// Peaks and valleys fold weirdness, which interpolation would smear, so it is always sampled per column
+	SetupNoiseSource(NewState->WeirdnessNoise, NoiseGenerationPreset->Weirdness, false, TEXT("Weirdness"));
+	SetupNoiseSource(NewState->TemperatureNoise, NoiseGenerationPreset->Temperature, true, TEXT("Temperature"));
+	SetupNoiseSource(NewState->HumidityNoise, NoiseGenerationPreset->Humidity, true, TEXT("Humidity"));
+	// 3D fields bring their own lattice, see DensityLatticeStepXY/Z
+	NewState->DensityNoise.Setup(NoiseGenerationPreset->Density, CachedSeed, 1);
+	NewState->CaveNoise.Setup(NoiseGenerationPreset->Caves, CachedSeed, 1);
+
+	NewState->ContinentalnessLUT = ContinentalnessLUT;
+	NewState->ErosionLUT = ErosionLUT;
+	NewState->WeirdnessLUT = WeirdnessLUT;
+	NewState->PeaksValleysLUT = PeaksValleysLUT;
+	NewState->BiomeClassifier = BiomeClassifier;
+	NewState->CompiledBiomes = CompiledBiomes;
+
+	if (CompiledBiomes)
+	{
+		TSharedPtr<FFoliageStampLibrary, ESPMode::ThreadSafe> Stamps = MakeShared<FFoliageStampLibrary, ESPMode::ThreadSafe>();
+		Stamps->Build(CachedSeed, *CompiledBiomes);
+		UE_LOG(LogTemp, Log, TEXT("UTerrainGenerator: Baked %d foliage stamps (%llu bytes)"), Stamps->NumStamps(), (uint64)Stamps->GetAllocatedSize());
+		NewState->FoliageStamps = Stamps;
+	}
 
-    FTerrainParameterData TerrainParams(SplinedContinentalness, SplinedErosion, SplinedWeirdness, SplinedPeaksValleys);
-    Column.SetGenerationData(TerrainParams); // Store calculated parameters in the column
+	NewState->WaterThreshold = WaterThreshold;
+	NewState->AltitudeTemperatureFactor = AltitudeTemperatureFactor;
+	NewState->TerrainBaseHeight = TerrainBaseHeight;
+	NewState->TerrainAmplitude = TerrainAmplitude;
+	NewState->ContinentalnessWeight = ContinentalnessWeight;
+	NewState->ErosionWeight = ErosionWeight;
+	NewState->PeaksValleysWeight = PeaksValleysWeight;
+
+	// Keeps the blend kernel within its per-column budget of 9x9 grid nodes
+	NewState->BiomeBlendRadius = BiomeBlendRadius;
+	NewState->BiomeBlendStep = FMath::Max(BiomeBlendGridStep, FMath::DivideAndRoundUp(BiomeBlendRadius, 4));
+	if (NewState->BiomeBlendStep != BiomeBlendGridStep)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("UTerrainGenerator: Biome blend grid step raised to %d to fit a radius of %d"), NewState->BiomeBlendStep, BiomeBlendRadius);
+	}
 
-    // Remap splined [0,1] values back to [-1,1] style for weighted sum
-    float ContRemapped = Remap01toNeg11(SplinedContinentalness);
-    float PVRemapped = Remap01toNeg11(SplinedPeaksValleys);
+	NewState->bDensityTerrain = bDensityTerrain;
+	NewState->SurfaceBandDepth = FMath::Max(1, SurfaceBandDepth);
+	NewState->DensityStepXY = DensityLatticeStepXY;
+	NewState->DensityStepZ = DensityLatticeStepZ;
+	NewState->CaveLayers = CaveLayers;
 
-    float BaseNoise =
-        ContRemapped * ContinentalnessWeight +
-        PVRemapped   * PeaksValleysWeight;
+	NewState->FoliagePlacement = FoliagePlacement;
+	NewState->FoliageCellSize = FMath::Max(2, FoliageGridCellSize);
+	NewState->FoliageMinSpacing = FMath::Clamp(FoliageMinSpacing, 0, NewState->FoliageCellSize - 1);
 
-    // Flatten factor based on Erosion
-    float FlattenFactor = FMath::Clamp(1.0f - SplinedErosion * ErosionWeight, 0.f, 1.f);
+	NewState->FieldCache.SetCapacity(FieldCacheMaxTiles);
+	NewState->Stats = GenerationStats;
 
-    float HeightNoise = BaseNoise * FlattenFactor;
-    float AbsoluteHeight = TerrainBaseHeight + HeightNoise * TerrainAmplitude;
+	State = NewState;
+}
 
-    int FinalBlockHeight = FMath::Clamp(FMath::RoundToInt(AbsoluteHeight), 0, ChunkHeight - 1);
-    Column.Height = FinalBlockHeight;
+void UTerrainGenerator::SetupNoiseSource(FTerrainNoiseSource& Source, const UNoiseOctaveSettingsAsset* Settings, bool bAllowCoarse, const TCHAR* FieldName) const
+{
+	const int32 Step = bCoarseNoiseSampling && bAllowCoarse && Settings ? Settings->CoarseSampleStep : 1;
+	Source.Setup(Settings, CachedSeed, Step);
+	if (Source.GetSampleStep() <= 1) return;
+
+	// Compare against full resolution over one cache tile; the error is in raw noise units, before normalization and splines
+	FTerrainFieldBuffer Probe;
+	Probe.Initialize(0, 0, FTerrainFieldCache::TileSize, FTerrainFieldCache::TileSize);
+
+	float MaxError, MeanError;
+	Source.MeasureCoarseError(Probe, MaxError, MeanError);
+	UE_LOG(LogTemp, Log, TEXT("UTerrainGenerator: Sampling %s every %d columns (%dx fewer noise evaluations), max error %f, mean error %f"),
+		FieldName, Step, Step * Step, MaxError, MeanError);
+}
 
+FTerrainSurfaceSample UTerrainGenerator::QuerySurface(int32 GlobalX, int32 GlobalY) const
+{
+	const FTerrainGeneratorStatePtr CurrentState = State;
+	return CurrentState ? CurrentState->QuerySurface(GlobalX, GlobalY) : GetFallbackSurface();
+}
 
-    float Temp01 = 0.5f;
-    if (TemperatureNoise) {
-        float RawTemp = TemperatureNoise->GetNoise2D(GlobalX, GlobalY);
-	    Temp01 = (RawTemp + 1.f) / 2.f;
-    }
-	float HeightDifference = static_cast<float>(FinalBlockHeight) - TerrainBaseHeight;
-	float AltitudeModifier = HeightDifference * AltitudeTemperatureFactor;
-	float FinalTemp01 = FMath::Clamp(Temp01 - AltitudeModifier, 0.0f, 1.0f);
-    Column.Temperature = FinalTemp01;
+void UTerrainGenerator::QuerySurfaceRegion(const FIntRect& Rect, TArray<FTerrainSurfaceSample>& OutSamples) const
+{
+	const FTerrainGeneratorStatePtr CurrentState = State;
+	if (CurrentState)
+	{
+		CurrentState->QuerySurfaceRegion(Rect, OutSamples);
+		return;
+	}
 
+	OutSamples.Init(GetFallbackSurface(), FMath::Max(0, Rect.Width()) * FMath::Max(0, Rect.Height()));
+}
 
-    float Humid01 = 0.5f;
-    if (HumidityNoise) {
-        float RawHumidity = HumidityNoise->GetNoise2D(GlobalX, GlobalY);
-	    Humid01 = (RawHumidity + 1.f) / 2.f;
-    }
-	Column.Humidity = FMath::Clamp(Humid01, 0.0f, 1.0f);
-	
-    // Remap calculated parameters to [-1, 1] for categorization
-    float Cont_neg1_1 = Remap01toNeg11(TerrainParams.Continentalness);
-    float Ero_neg1_1 = Remap01toNeg11(TerrainParams.Erosion);
-    float Weird_neg1_1 = Remap01toNeg11(TerrainParams.Weirdness);
-    float PV_neg1_1_biome = Remap01toNeg11(TerrainParams.PeaksValleys);
-    float Temp_neg1_1 = Remap01toNeg11(FinalTemp01);
-    float Humid_neg1_1 = Remap01toNeg11(Column.Humidity);
-
-    // Categorize based on thresholds
-    ETemperatureType CatTemp = CategorizeTemperature(Temp_neg1_1);
-    EHumidityType CatHumid = CategorizeHumidity(Humid_neg1_1);
-    EContinentalnessType CatCont = CategorizeContinentalness(Cont_neg1_1);
-    EErosionType CatEro = CategorizeErosion(Ero_neg1_1);
-    EPVType CatPV = CategorizePV(PV_neg1_1_biome);
-
-    FCategorizedBiomeInputs BiomeInputs(CatTemp, CatHumid, CatCont, CatEro, CatPV, Weird_neg1_1);
-
-    EBiomeType FinalBiome = DetermineBiomeType(BiomeInputs);
-    Column.SetBiomeType(FinalBiome);
+FChunkColumn UTerrainGenerator::GenerateColumnData(int GlobalX, int GlobalY) const
+{
+	if (const FTerrainGeneratorStatePtr CurrentState = State)
+	{
+		return CurrentState->GenerateColumnData(GlobalX, GlobalY);
+	}
 
+	UE_LOG(LogTemp, Error, TEXT("GenerateColumnData called before noise was initialized for (%d, %d)!"), GlobalX, GlobalY);
+	FChunkColumn Column(GlobalX, GlobalY);
+	Column.SetSurfaceSample(GetFallbackSurface());
 	return Column;
 }
 
-
-FTerrainParameterData UTerrainGenerator::CalculateTerrainParameters(int GlobalX, int GlobalY) const
+void UTerrainGenerator::GenerateChunk(const FIntVector2& ChunkGridPosition, FChunkVoxels& OutVoxels) const
 {
-    float RawCont = ContinentalnessNoise ? ContinentalnessNoise->GetNoise2D(GlobalX, GlobalY) : 0.f;
-	float RawErosion = ErosionNoise ? ErosionNoise->GetNoise2D(GlobalX, GlobalY) : 0.f;
-	float RawWeirdness = WeirdnessNoise ? WeirdnessNoise->GetNoise2D(GlobalX, GlobalY) : 0.f;
-
-	float Cont01 = (RawCont + 1.f) / 2.f;
-	float Ero01 = (RawErosion + 1.f) / 2.f;
-	float Weird01 = (RawWeirdness + 1.f) / 2.f;
+	if (const FTerrainGeneratorStatePtr CurrentState = State)
+	{
+		CurrentState->GenerateChunk(ChunkGridPosition, OutVoxels);
+		return;
+	}
 
-    float PV_neg1_1 = 1.0f - FMath::Abs((3.0f * FMath::Abs(RawWeirdness)) - 2.0f);
-	float PV01_forSpline = (PV_neg1_1 + 1.f) / 2.f;
+	UE_LOG(LogTemp, Error, TEXT("GenerateChunk called before noise was initialized for chunk (%d, %d)!"), ChunkGridPosition.X, ChunkGridPosition.Y);
+	OutVoxels.Reset();
+}
 
-    float SplinedContinentalness, SplinedErosion, SplinedWeirdness, SplinedPeaksValleys;
-    ApplySpline(ContinentalnessSpline, Cont01, SplinedContinentalness);
-	ApplySpline(ErosionSpline, Ero01, SplinedErosion);
-	ApplySpline(WeirdnessSpline, Weird01, SplinedWeirdness);
-    ApplySpline(PeaksValleysSpline, PV01_forSpline, SplinedPeaksValleys);
+FTerrainSurfaceSample UTerrainGenerator::GetFallbackSurface() const
+{
+	FTerrainSurfaceSample Sample;
+	Sample.Height = FMath::Clamp(FMath::RoundToInt(TerrainBaseHeight), 0, FMath::Max(CachedChunkHeight - 1, 0));
+	Sample.Temperature = 0.5f;
+	Sample.Humidity = 0.5f;
+	return Sample;
+}
 
-    return FTerrainParameterData(SplinedContinentalness, SplinedErosion, SplinedWeirdness, SplinedPeaksValleys);
+void UTerrainGenerator::BuildBiomeClassifier()
+{
+	BiomeClassifier.Build(TemperatureThresholds, HumidityThresholds, ContinentalnessThresholds, ErosionThresholds, PeaksValleysThresholds,
+		[this](const FCategorizedBiomeInputs& Inputs) { return DetermineBiomeType(Inputs); });
 }
 
-void UTerrainGenerator::ApplySpline(const UCurveFloat* Spline, float InValue, float& OutValue) const
+void UTerrainGenerator::CompileBiomeTable()
 {
-	if (Spline)
+	if (CompiledBiomesSource.IsValid())
 	{
-		OutValue = Spline->GetFloatValue(InValue);
+		CompiledBiomesSource->OnDataTableChanged().RemoveAll(this);
 	}
-	else
+
+	// Built aside and swapped in whole, so readers never see a half-compiled table
+	TSharedPtr<FCompiledBiomeTable, ESPMode::ThreadSafe> NewTable = MakeShared<FCompiledBiomeTable, ESPMode::ThreadSafe>();
+	NewTable->Compile(BiomesTable);
+	CompiledBiomes = NewTable;
+	CompiledBiomesSource = BiomesTable;
+
+	// Row edits and reimports recompile the table
+	if (BiomesTable)
 	{
-		OutValue = InValue;
+		BiomesTable->OnDataTableChanged().AddUObject(this, &UTerrainGenerator::OnBiomesTableChanged);
 	}
 }
 
-void UTerrainGenerator::PopulateColumnBlocks(FChunkColumn& ColumnData) const
+void UTerrainGenerator::OnBiomesTableChanged()
 {
-	FBiomeSettings* BiomeSettings = GetBiomeSettings(ColumnData.GetBiomeType());
-    const int ChunkHeight = FChunkData::GetChunkHeight(this);
-
-	if (!BiomeSettings)
+	CompileBiomeTable();
+	if (State)
 	{
-        for(int z = 0; z <= ColumnData.Height && z < ChunkHeight; ++z)
-        {
-            if (z >= 0) ColumnData.Blocks[z] = EBlock::Stone;
-        }
-		return;
+		RebuildState();
 	}
+}
 
-	int CurrentHeight = ColumnData.Height;
-	for (const auto& Layer : BiomeSettings->Layers)
-	{
-		if (Layer.LayerThickness <= 0) continue;
-
-        // Calculate the bottom Z index for this layer (inclusive)
-		int LayerBottomHeight = CurrentHeight - (Layer.LayerThickness -1);
-
-		for (int z = CurrentHeight; z >= LayerBottomHeight; --z)
-		{
-			if (z >= 0 && z < ChunkHeight)
-			{
-				ColumnData.Blocks[z] = Layer.BlockType;
-            }
-		    else
-            {
-                break;
-            }
-		}
-		CurrentHeight = LayerBottomHeight - 1;
-		if (CurrentHeight < 0) break;
-	}
+#if WITH_EDITOR
+void UTerrainGenerator::PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent)
+{
+	Super::PostEditChangeProperty(PropertyChangedEvent);
 
-    if (CurrentHeight >= 0) {
-        for (int z = CurrentHeight; z >= 0; --z)
-        {
-            if (z < ChunkHeight)
-            {
-                ColumnData.Blocks[z] = EBlock::Stone;
-            }
-        }
-    }
+	// Only a live generator needs its snapshot rebuilt; otherwise everything is compiled on initialization
+	if (!State) return;
 
-	if (ColumnData.Height < WaterThreshold) {
-		for (int z = ColumnData.Height + 1; z <= WaterThreshold; ++z)
-		{
-			if (z >= 0 && z < ChunkHeight)
-			{
-                 ColumnData.Blocks[z] = EBlock::Water;
-			}
-		}
+	const FName MemberName = PropertyChangedEvent.GetMemberPropertyName();
+	if (MemberName == GET_MEMBER_NAME_CHECKED(UTerrainGenerator, BiomesTable))
+	{
+		CompileBiomeTable();
+	}
+	else if (MemberName == GET_MEMBER_NAME_CHECKED(UTerrainGenerator, TemperatureThresholds)
+		|| MemberName == GET_MEMBER_NAME_CHECKED(UTerrainGenerator, HumidityThresholds)
+		|| MemberName == GET_MEMBER_NAME_CHECKED(UTerrainGenerator, ContinentalnessThresholds)
+		|| MemberName == GET_MEMBER_NAME_CHECKED(UTerrainGenerator, ErosionThresholds)
+		|| MemberName == GET_MEMBER_NAME_CHECKED(UTerrainGenerator, PeaksValleysThresholds))
+	{
+		BuildBiomeClassifier();
+	}
+	else if (MemberName == GET_MEMBER_NAME_CHECKED(UTerrainGenerator, ContinentalnessSpline)
+		|| MemberName == GET_MEMBER_NAME_CHECKED(UTerrainGenerator, ErosionSpline)
+		|| MemberName == GET_MEMBER_NAME_CHECKED(UTerrainGenerator, WeirdnessSpline)
+		|| MemberName == GET_MEMBER_NAME_CHECKED(UTerrainGenerator, PeaksValleysSpline)
+		|| MemberName == GET_MEMBER_NAME_CHECKED(UTerrainGenerator, SplineLUTResolution))
+	{
+		BakeSplineLUTs();
 	}
-}
 
+	RebuildState();
+}
+#endif
 
-void UTerrainGenerator::DecorateChunkWithFoliage(TArray<FChunkColumn>& InOutChunkColumns,
-	const FIntVector2& ChunkGridPosition, const FRandomStream& WorldFoliageStreamBase) const
+void UTerrainGenerator::BakeSplineLUTs()
 {
-	if (!bNoiseInitialized || InOutChunkColumns.IsEmpty() || !FoliageGenerator) return;
+	BakeSplineLUT(ContinentalnessLUT, ContinentalnessSpline, TEXT("Continentalness"));
+	BakeSplineLUT(ErosionLUT, ErosionSpline, TEXT("Erosion"));
+	BakeSplineLUT(WeirdnessLUT, WeirdnessSpline, TEXT("Weirdness"));
+	BakeSplineLUT(PeaksValleysLUT, PeaksValleysSpline, TEXT("PeaksValleys"));
+}
 
-    int ChunkSize = FChunkData::GetChunkSize(this);
-	const int ChunkHeight = FChunkData::GetChunkHeight(this);
+void UTerrainGenerator::BakeSplineLUT(FSplineLUT& LUT, const UCurveFloat* Spline, const TCHAR* SplineName) const
+{
+	LUT.Bake(Spline, SplineLUTResolution);
+	if (!LUT.IsBaked()) return;
 
-    for (int Y_Local = 0; Y_Local < ChunkSize; ++Y_Local)
-    {
-        for (int X_Local = 0; X_Local < ChunkSize; ++X_Local)
-        {
-            int ColumnIndex = FChunkData::GetColumnIndex(this, X_Local, Y_Local);
-            if (!InOutChunkColumns.IsValidIndex(ColumnIndex)) continue;
-
-            FChunkColumn& CurrentColumn = InOutChunkColumns[ColumnIndex];
-            EBiomeType BiomeType = CurrentColumn.GetBiomeType();
-            FBiomeSettings* BiomeInfo = GetBiomeSettings(BiomeType);
-
-            if (!BiomeInfo || BiomeInfo->FoliageRules.IsEmpty()) continue;
-
-            FRandomStream ColumnFoliageDecisionStream;
-            int32 GlobalX = ChunkGridPosition.X * ChunkSize + X_Local;
-            int32 GlobalY = ChunkGridPosition.Y * ChunkSize + Y_Local;
-
-            ColumnFoliageDecisionStream.Initialize(
-                WorldFoliageStreamBase.GetCurrentSeed() ^ GlobalX ^ (GlobalY << 16) ^ (GlobalY >> 16)
-            );
-
-            FoliageGenerator->AttemptPlaceFoliageAt(
-                InOutChunkColumns,
-                X_Local, Y_Local,
-                BiomeInfo,
-                ColumnFoliageDecisionStream,
-                ChunkSize,
-                ChunkHeight
-            );
-        }
-    }
+	// Probe well between the baked samples so the reported error reflects the interpolation
+	const float MaxError = LUT.MeasureMaxError(Spline, SplineLUTResolution * 8);
+	UE_LOG(LogTemp, Log, TEXT("UTerrainGenerator: Baked %s spline into %d samples, max error %f"),
+		SplineName, LUT.GetResolution(), MaxError);
 }
 
 EBiomeType UTerrainGenerator::DetermineBiomeType(const FCategorizedBiomeInputs& Params) const
@@ -453,11 +454,3 @@ EBiomeType UTerrainGenerator::MapShatteredBiome(ETemperatureType Temp, EHumidity
 
     return MapMiddleBiome(Temp, Hum, Weirdness_neg1_1);
 }
-
-FBiomeSettings* UTerrainGenerator::GetBiomeSettings(EBiomeType BiomeType) const
-{
-	if (!BiomesTable) return nullptr;
-	FName BiomeName = BiomeTypeToFName(BiomeType);
-    if (BiomeName == NAME_None) return nullptr;
-	return BiomesTable->FindRow<FBiomeSettings>(BiomeName, TEXT("Lookup Biome Settings"));
-}
\ No newline at end of file
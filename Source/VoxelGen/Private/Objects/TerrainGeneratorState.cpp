@@ -0,0 +1,781 @@
+﻿#include "Objects/TerrainGeneratorState.h"
+
+#include "Objects/FoliageGenerator.h"
+#include "Structs/ChunkColumn.h"
+#include "Structs/ChunkData.h"
+
+FTerrainSurfaceSample FTerrainGeneratorState::QuerySurface(int32 GlobalX, int32 GlobalY) const
+{
+	const FTerrainFieldCache::FTileRef Tile = GetFieldTile(FTerrainFieldCache::GetTileCoordinates(GlobalX, GlobalY));
+	const FTerrainFieldBuffer& Fields = Tile->Fields;
+	FTerrainSurfaceSample Sample = Fields.GetSample(Fields.GetIndex(GlobalX - Fields.OriginX, GlobalY - Fields.OriginY));
+
+	BlendBiomeBorders(FIntRect(GlobalX, GlobalY, GlobalX + 1, GlobalY + 1), MakeArrayView(&Sample, 1));
+	return Sample;
+}
+
+void FTerrainGeneratorState::QuerySurfaceRegion(const FIntRect& Rect, TArray<FTerrainSurfaceSample>& OutSamples) const
+{
+	const int32 Width = FMath::Max(0, Rect.Width());
+	const int32 Height = FMath::Max(0, Rect.Height());
+	OutSamples.SetNumUninitialized(Width * Height, EAllowShrinking::No);
+
+	if (OutSamples.IsEmpty())
+	{
+		return;
+	}
+
+	ReadSurfaceRegion(Rect, OutSamples);
+
+	FScopedGenerationStageTimer Timer(Stats->BlendCycles);
+	BlendBiomeBorders(Rect, OutSamples);
+}
+
+void FTerrainGeneratorState::ReadSurfaceRegion(const FIntRect& Rect, TArrayView<FTerrainSurfaceSample> OutSamples) const
+{
+	const int32 Width = Rect.Width();
+
+	const FIntVector2 MinTile = FTerrainFieldCache::GetTileCoordinates(Rect.Min.X, Rect.Min.Y);
+	const FIntVector2 MaxTile = FTerrainFieldCache::GetTileCoordinates(Rect.Max.X - 1, Rect.Max.Y - 1);
+
+	for (int32 TileY = MinTile.Y; TileY <= MaxTile.Y; ++TileY)
+	{
+		for (int32 TileX = MinTile.X; TileX <= MaxTile.X; ++TileX)
+		{
+			const FTerrainFieldCache::FTileRef Tile = GetFieldTile(FIntVector2(TileX, TileY));
+			const FTerrainFieldBuffer& Fields = Tile->Fields;
+
+			// Overlap of the tile and the rect, in global columns
+			const int32 MinX = FMath::Max(Rect.Min.X, Fields.OriginX);
+			const int32 MaxX = FMath::Min(Rect.Max.X, Fields.OriginX + Fields.SizeX);
+			const int32 MinY = FMath::Max(Rect.Min.Y, Fields.OriginY);
+			const int32 MaxY = FMath::Min(Rect.Max.Y, Fields.OriginY + Fields.SizeY);
+
+			for (int32 GlobalY = MinY; GlobalY < MaxY; ++GlobalY)
+			{
+				const int32 From = Fields.GetIndex(MinX - Fields.OriginX, GlobalY - Fields.OriginY);
+				FTerrainSurfaceSample* To = OutSamples.GetData() + (MinX - Rect.Min.X) + (GlobalY - Rect.Min.Y) * Width;
+				for (int32 i = 0; i < MaxX - MinX; ++i)
+				{
+					To[i] = Fields.GetSample(From + i);
+				}
+			}
+		}
+	}
+}
+
+FChunkColumn FTerrainGeneratorState::GenerateColumnData(int32 GlobalX, int32 GlobalY) const
+{
+	FChunkColumn Column(GlobalX, GlobalY);
+	Column.SetSurfaceSample(QuerySurface(GlobalX, GlobalY));
+	return Column;
+}
+
+FTerrainFieldCache::FTileRef FTerrainGeneratorState::GetFieldTile(const FIntVector2& TileCoordinates) const
+{
+	return FieldCache.GetTile(TileCoordinates, [this](FTerrainFieldBuffer& Fields) { GenerateTerrainFields(Fields); });
+}
+
+void FTerrainGeneratorState::GenerateChunk(const FIntVector2& ChunkGridPosition, FChunkVoxels& OutVoxels) const
+{
+    OutVoxels.Initialize(ChunkSize, ChunkHeight);
+    GenerateChunkColumns(ChunkGridPosition, OutVoxels.Columns);
+
+    {
+        FScopedGenerationStageTimer Timer(Stats->PopulateCycles);
+        for (int32 ColumnIndex = 0; ColumnIndex < OutVoxels.NumColumns(); ++ColumnIndex)
+        {
+            PopulateColumnBlocks(OutVoxels.Columns[ColumnIndex], OutVoxels.GetColumnBlocks(ColumnIndex));
+        }
+    }
+
+    if (HasDensityStage())
+    {
+        FScopedGenerationStageTimer Timer(Stats->DensityCycles);
+        DensityStage(ChunkGridPosition, OutVoxels);
+    }
+
+    {
+        FScopedGenerationStageTimer Timer(Stats->FoliageCycles);
+        FRandomStream Stream(GetFoliageStreamSeed(ChunkGridPosition));
+        DecorateChunkWithFoliage(OutVoxels, ChunkGridPosition, Stream);
+    }
+
+    OutVoxels.UpdateSections();
+    uint64 SectionCounts[3] = {};
+    for (int32 SectionIndex = 0; SectionIndex < OutVoxels.NumSections(); ++SectionIndex)
+    {
+        ++SectionCounts[static_cast<uint8>(OutVoxels.GetSection(SectionIndex).State)];
+    }
+    Stats->SectionsEmpty.fetch_add(SectionCounts[static_cast<uint8>(EChunkSectionState::Empty)], std::memory_order_relaxed);
+    Stats->SectionsUniform.fetch_add(SectionCounts[static_cast<uint8>(EChunkSectionState::Uniform)], std::memory_order_relaxed);
+    Stats->SectionsMixed.fetch_add(SectionCounts[static_cast<uint8>(EChunkSectionState::Mixed)], std::memory_order_relaxed);
+
+    Stats->ChunksGenerated.fetch_add(1, std::memory_order_relaxed);
+}
+
+void FTerrainGeneratorState::GenerateChunkColumns(const FIntVector2& ChunkGridPosition, TArray<FChunkColumn>& OutColumns) const
+{
+    OutColumns.SetNum(ChunkSize * ChunkSize);
+
+    const FIntPoint Origin(ChunkGridPosition.X * ChunkSize, ChunkGridPosition.Y * ChunkSize);
+    TArray<FTerrainSurfaceSample> Samples;
+    QuerySurfaceRegion(FIntRect(Origin, Origin + FIntPoint(ChunkSize, ChunkSize)), Samples);
+
+    for (int32 y = 0; y < ChunkSize; ++y)
+    {
+        for (int32 x = 0; x < ChunkSize; ++x)
+        {
+            FChunkColumn& Column = OutColumns[FChunkData::GetColumnIndexFromLocal(x, y, ChunkSize)];
+            Column = FChunkColumn(Origin.X + x, Origin.Y + y);
+            Column.SetSurfaceSample(Samples[x + y * ChunkSize]);
+        }
+    }
+}
+
+void FTerrainGeneratorState::BlendBiomeBorders(const FIntRect& Rect, TArrayView<FTerrainSurfaceSample> InOutSamples) const
+{
+    if (!CompiledBiomes) return;
+
+    const int32 Width = Rect.Width();
+
+    auto GetHeightOffset = [this](EBiomeType BiomeType)
+    {
+        const FCompiledBiome* Biome = CompiledBiomes->Find(BiomeType);
+        return Biome ? Biome->HeightOffset : 0.f;
+    };
+
+    auto ApplyHeightOffset = [this](FTerrainSurfaceSample& Sample, float Offset)
+    {
+        Sample.Height = FMath::Clamp(FMath::RoundToInt(Sample.Height + Offset), 0, ChunkHeight - 1);
+    };
+
+    if (BiomeBlendRadius <= 0)
+    {
+        for (FTerrainSurfaceSample& Sample : InOutSamples)
+        {
+            ApplyHeightOffset(Sample, GetHeightOffset(Sample.Biome));
+        }
+        return;
+    }
+
+    FBiomeBlendGrid Grid;
+    Grid.Initialize(Rect.Min.X, Rect.Min.Y, Width, Rect.Height(), BiomeBlendRadius, BiomeBlendStep);
+
+    // Nodes are read from the cached tiles, only looking a tile up again when the node crosses into another one
+    TArray<EBiomeType, TInlineAllocator<96>>& GridBiomes = Grid.GetBiomes();
+    FTerrainFieldCache::FTileRef Tile;
+    FIntVector2 TileCoordinates;
+    for (int32 NodeY = 0; NodeY < Grid.GetNodeCountY(); ++NodeY)
+    {
+        for (int32 NodeX = 0; NodeX < Grid.GetNodeCountX(); ++NodeX)
+        {
+            const FIntPoint NodeColumn = Grid.GetNodeColumn(NodeX, NodeY);
+            const FIntVector2 NodeTile = FTerrainFieldCache::GetTileCoordinates(NodeColumn.X, NodeColumn.Y);
+            if (!Tile || NodeTile != TileCoordinates)
+            {
+                Tile = GetFieldTile(NodeTile);
+                TileCoordinates = NodeTile;
+            }
+
+            const FTerrainFieldBuffer& Fields = Tile->Fields;
+            GridBiomes[NodeX + NodeY * Grid.GetNodeCountX()] = Fields.Biome[Fields.GetIndex(NodeColumn.X - Fields.OriginX, NodeColumn.Y - Fields.OriginY)];
+        }
+    }
+
+    FBiomeWeights Weights;
+    for (int32 Index = 0; Index < InOutSamples.Num(); ++Index)
+    {
+        FTerrainSurfaceSample& Sample = InOutSamples[Index];
+        const int32 GlobalX = Rect.Min.X + Index % Width;
+        const int32 GlobalY = Rect.Min.Y + Index / Width;
+        Grid.ComputeWeights(GlobalX, GlobalY, Weights);
+
+        float Offset = 0.f;
+        for (int32 i = 0; i < Weights.Num(); ++i)
+        {
+            Offset += Weights[i].Weight * GetHeightOffset(Weights[i].Biome);
+        }
+        ApplyHeightOffset(Sample, Offset);
+
+        // Surface layers and foliage follow a biome picked per column, so borders dither instead of stepping
+        if (Weights.Num() > 1)
+        {
+            uint32 Hash = static_cast<uint32>(GlobalX) * 73856093u ^ static_cast<uint32>(GlobalY) * 19349663u ^ static_cast<uint32>(Seed) * 83492791u;
+            Hash ^= Hash >> 16;
+            Hash *= 0x7feb352du;
+            Hash ^= Hash >> 15;
+            Hash *= 0x846ca68bu;
+            Hash ^= Hash >> 16;
+            Sample.Biome = Weights.Pick((Hash & 0xFFFFFF) / static_cast<float>(0x1000000));
+        }
+    }
+}
+
+void FTerrainGeneratorState::GenerateTerrainFields(FTerrainFieldBuffer& Fields) const
+{
+    {
+        FScopedGenerationStageTimer Timer(Stats->NoiseCycles);
+        SampleNoiseStage(Fields);
+        NormalizeNoiseStage(Fields);
+    }
+    {
+        FScopedGenerationStageTimer Timer(Stats->SplineCycles);
+        SplineStage(Fields);
+    }
+    {
+        FScopedGenerationStageTimer Timer(Stats->HeightCycles);
+        HeightStage(Fields);
+    }
+    {
+        FScopedGenerationStageTimer Timer(Stats->ClassificationCycles);
+        BiomeStage(Fields);
+    }
+
+    Stats->FieldColumnsGenerated.fetch_add(Fields.Num(), std::memory_order_relaxed);
+}
+
+void FTerrainGeneratorState::SampleNoiseStage(FTerrainFieldBuffer& Fields) const
+{
+    // One field at a time keeps each noise generator hot and hoists the null checks out of the loop
+    ContinentalnessNoise.SampleRegion(Fields, Fields.Continentalness);
+    ErosionNoise.SampleRegion(Fields, Fields.Erosion);
+    WeirdnessNoise.SampleRegion(Fields, Fields.Weirdness);
+    TemperatureNoise.SampleRegion(Fields, Fields.Temperature);
+    HumidityNoise.SampleRegion(Fields, Fields.Humidity);
+}
+
+void FTerrainGeneratorState::NormalizeNoiseStage(FTerrainFieldBuffer& Fields) const
+{
+    // Raw noise [-1, 1] -> [0, 1]; peaks and valleys are folded from raw weirdness before it is overwritten
+    float* Cont = Fields.Continentalness.GetData();
+    float* Ero = Fields.Erosion.GetData();
+    float* Weird = Fields.Weirdness.GetData();
+    float* PV = Fields.PeaksValleys.GetData();
+    float* Temp = Fields.Temperature.GetData();
+    float* Humid = Fields.Humidity.GetData();
+
+    const int32 Count = Fields.Num();
+    const int32 VectorCount = Count & ~3;
+
+    const VectorRegister4Float One = GlobalVectorConstants::FloatOne;
+    const VectorRegister4Float Half = VectorSetFloat1(0.5f);
+    const VectorRegister4Float Two = VectorSetFloat1(2.0f);
+    const VectorRegister4Float Three = VectorSetFloat1(3.0f);
+
+    auto Normalize = [&One, &Half](float* Values)
+    {
+        VectorStore(VectorMultiply(VectorAdd(VectorLoad(Values), One), Half), Values);
+    };
+
+    for (int32 i = 0; i < VectorCount; i += 4)
+    {
+        const VectorRegister4Float RawWeird = VectorLoad(Weird + i);
+        const VectorRegister4Float PVNeg11 = VectorSubtract(One, VectorAbs(VectorSubtract(VectorMultiply(Three, VectorAbs(RawWeird)), Two)));
+        VectorStore(VectorMultiply(VectorAdd(PVNeg11, One), Half), PV + i);
+
+        Normalize(Cont + i);
+        Normalize(Ero + i);
+        Normalize(Weird + i);
+        Normalize(Temp + i);
+        Normalize(Humid + i);
+    }
+
+    for (int32 i = VectorCount; i < Count; ++i)
+    {
+        const float PVNeg11 = 1.0f - FMath::Abs((3.0f * FMath::Abs(Weird[i])) - 2.0f);
+        PV[i] = (PVNeg11 + 1.f) / 2.f;
+
+        Cont[i] = (Cont[i] + 1.f) / 2.f;
+        Ero[i] = (Ero[i] + 1.f) / 2.f;
+        Weird[i] = (Weird[i] + 1.f) / 2.f;
+        Temp[i] = (Temp[i] + 1.f) / 2.f;
+        Humid[i] = (Humid[i] + 1.f) / 2.f;
+    }
+}
+
+void FTerrainGeneratorState::SplineStage(FTerrainFieldBuffer& Fields) const
+{
+    const int32 Count = Fields.Num();
+    for (int32 i = 0; i < Count; ++i)
+    {
+        ApplySpline(ContinentalnessLUT, Fields.Continentalness[i], Fields.Continentalness[i]);
+        ApplySpline(ErosionLUT, Fields.Erosion[i], Fields.Erosion[i]);
+        ApplySpline(WeirdnessLUT, Fields.Weirdness[i], Fields.Weirdness[i]);
+        ApplySpline(PeaksValleysLUT, Fields.PeaksValleys[i], Fields.PeaksValleys[i]);
+    }
+}
+
+void FTerrainGeneratorState::HeightStage(FTerrainFieldBuffer& Fields) const
+{
+    const int32 Count = Fields.Num();
+
+    for (int32 i = 0; i < Count; ++i)
+    {
+        const float BaseNoise =
+            Remap01toNeg11(Fields.Continentalness[i]) * ContinentalnessWeight +
+            Remap01toNeg11(Fields.PeaksValleys[i])    * PeaksValleysWeight;
+
+        // Flatten factor based on Erosion
+        const float FlattenFactor = FMath::Clamp(1.0f - Fields.Erosion[i] * ErosionWeight, 0.f, 1.f);
+
+        const float AbsoluteHeight = TerrainBaseHeight + BaseNoise * FlattenFactor * TerrainAmplitude;
+        const int FinalBlockHeight = FMath::Clamp(FMath::RoundToInt(AbsoluteHeight), 0, ChunkHeight - 1);
+        Fields.Height[i] = FinalBlockHeight;
+
+        // Temperature drops with altitude
+        const float AltitudeModifier = (static_cast<float>(FinalBlockHeight) - TerrainBaseHeight) * AltitudeTemperatureFactor;
+        Fields.Temperature[i] = FMath::Clamp(Fields.Temperature[i] - AltitudeModifier, 0.0f, 1.0f);
+        Fields.Humidity[i] = FMath::Clamp(Fields.Humidity[i], 0.0f, 1.0f);
+    }
+}
+
+void FTerrainGeneratorState::BiomeStage(FTerrainFieldBuffer& Fields) const
+{
+    const int32 Count = Fields.Num();
+    for (int32 i = 0; i < Count; ++i)
+    {
+        Fields.Biome[i] = BiomeClassifier.Classify(
+            Remap01toNeg11(Fields.Temperature[i]),
+            Remap01toNeg11(Fields.Humidity[i]),
+            Remap01toNeg11(Fields.Continentalness[i]),
+            Remap01toNeg11(Fields.Erosion[i]),
+            Remap01toNeg11(Fields.PeaksValleys[i]),
+            Remap01toNeg11(Fields.Weirdness[i]));
+    }
+}
+
+void FTerrainGeneratorState::ApplySpline(const FSplineLUT& SplineLUT, float InValue, float& OutValue) const
+{
+	if (SplineLUT.IsBaked())
+	{
+		OutValue = SplineLUT.Evaluate(InValue);
+	}
+	else
+	{
+		OutValue = InValue;
+	}
+}
+
+void FTerrainGeneratorState::BuildColumnSpans(const FChunkColumn& ColumnData, FColumnSpans& OutSpans) const
+{
+	OutSpans.Reset();
+
+	const FCompiledBiome* Biome = CompiledBiomes ? CompiledBiomes->Find(ColumnData.GetBiomeType()) : nullptr;
+    const int32 SurfaceEnd = FMath::Min(ColumnData.Height, ChunkHeight - 1) + 1;
+
+	if (!Biome)
+	{
+        OutSpans.Add(EBlock::Stone, 0, SurfaceEnd);
+		return;
+	}
+
+    // Stone up to the surface layers, then the layers bottom-up, clipped at the bottom of the world
+    OutSpans.Add(EBlock::Stone, 0, SurfaceEnd - Biome->SurfaceDepth);
+    for (int32 LayerIndex = Biome->SurfaceLayers.Num() - 1; LayerIndex >= 0; --LayerIndex)
+    {
+        const FColumnSpan& Layer = Biome->SurfaceLayers[LayerIndex];
+        OutSpans.Add(Layer.Block, FMath::Max(0, SurfaceEnd - Layer.End), SurfaceEnd - Layer.Start);
+    }
+
+	if (ColumnData.Height < WaterThreshold)
+	{
+        OutSpans.Add(EBlock::Water, FMath::Max(0, ColumnData.Height + 1), FMath::Min(WaterThreshold + 1, ChunkHeight));
+	}
+}
+
+void FTerrainGeneratorState::PopulateColumnBlocks(const FChunkColumn& ColumnData, TArrayView<EBlock> OutBlocks) const
+{
+    FColumnSpans Spans;
+    BuildColumnSpans(ColumnData, Spans);
+    Spans.Fill(OutBlocks);
+}
+
+void FTerrainGeneratorState::DensityStage(const FIntVector2& ChunkGridPosition, FChunkVoxels& InOutVoxels) const
+{
+    const int32 OriginX = ChunkGridPosition.X * ChunkSize;
+    const int32 OriginY = ChunkGridPosition.Y * ChunkSize;
+
+    uint64 VoxelsEvaluated = 0;
+    uint64 NodesSampled = 0;
+
+    // One lattice over the band of the whole chunk; columns then only interpolate their own slice of it
+    FDensityLattice SurfaceLattice;
+    if (DensityNoise.IsValid())
+    {
+        SampleSurfaceLattice(FIntRect(OriginX, OriginY, OriginX + ChunkSize, OriginY + ChunkSize), InOutVoxels.Columns, SurfaceLattice);
+        NodesSampled += SurfaceLattice.NumNodes();
+    }
+
+    TArray<FDensityLattice, TInlineAllocator<4>> CaveLattices;
+    if (CaveNoise.IsValid())
+    {
+        CaveLattices.SetNum(CaveLayers.Num());
+        for (int32 LayerIndex = 0; LayerIndex < CaveLayers.Num(); ++LayerIndex)
+        {
+            const FCaveLayer& Layer = CaveLayers[LayerIndex];
+            CaveLattices[LayerIndex].Sample(CaveNoise, DensityStepXY, DensityStepZ, OriginX, OriginY, ChunkSize, ChunkSize,
+                FMath::Max(0, Layer.MinHeight), FMath::Min(ChunkHeight, Layer.MaxHeight));
+            NodesSampled += CaveLattices[LayerIndex].NumNodes();
+        }
+    }
+
+    TArray<float, TInlineAllocator<260>> Density;
+    Density.SetNumUninitialized(ChunkHeight + 3);
+
+    for (int32 ColumnIndex = 0; ColumnIndex < InOutVoxels.NumColumns(); ++ColumnIndex)
+    {
+        FChunkColumn& Column = InOutVoxels.Columns[ColumnIndex];
+        EBlock* Blocks = InOutVoxels.GetColumnBlocks(ColumnIndex).GetData();
+
+        if (!SurfaceLattice.IsEmpty())
+        {
+            VoxelsEvaluated += ResurfaceColumn(Column, Blocks, SurfaceLattice, Density.GetData());
+        }
+
+        for (int32 LayerIndex = 0; LayerIndex < CaveLattices.Num(); ++LayerIndex)
+        {
+            const FDensityLattice& Lattice = CaveLattices[LayerIndex];
+            if (Lattice.IsEmpty()) continue;
+
+            // Caves only carve below the surface, so they never cut into water or open the sky over it
+            const FCaveLayer& Layer = CaveLayers[LayerIndex];
+            const int32 MinZ = FMath::Max(0, Layer.MinHeight);
+            const int32 MaxZ = FMath::Min3(ChunkHeight, Layer.MaxHeight, Column.Height);
+            if (MaxZ <= MinZ) continue;
+
+            Lattice.InterpolateColumn(Column.X, Column.Y, MinZ, MaxZ, Density.GetData());
+            VoxelsEvaluated += MaxZ - MinZ;
+
+            for (int32 z = MinZ; z < MaxZ; ++z)
+            {
+                if (Density[z - MinZ] > Layer.Threshold && Blocks[z] != EBlock::Water)
+                {
+                    Blocks[z] = EBlock::Air;
+                }
+            }
+        }
+    }
+
+    Stats->DensityVoxelsEvaluated.fetch_add(VoxelsEvaluated, std::memory_order_relaxed);
+    Stats->DensityNodesSampled.fetch_add(NodesSampled, std::memory_order_relaxed);
+}
+
+void FTerrainGeneratorState::GetSurfaceBand(const FChunkColumn& Column, int32& OutMinZ, int32& OutMaxZ) const
+{
+    // Outside the band the height gradient outweighs any noise in [-1, 1], so those voxels are already decided
+    OutMinZ = FMath::Max(0, Column.Height - SurfaceBandDepth + 1);
+    OutMaxZ = FMath::Min(ChunkHeight, Column.Height + SurfaceBandDepth);
+}
+
+void FTerrainGeneratorState::SampleSurfaceLattice(const FIntRect& Rect, TConstArrayView<FChunkColumn> Columns, FDensityLattice& OutLattice) const
+{
+    int32 RectMinZ = ChunkHeight;
+    int32 RectMaxZ = 0;
+    for (const FChunkColumn& Column : Columns)
+    {
+        int32 MinZ, MaxZ;
+        GetSurfaceBand(Column, MinZ, MaxZ);
+        RectMinZ = FMath::Min(RectMinZ, MinZ);
+        RectMaxZ = FMath::Max(RectMaxZ, MaxZ);
+    }
+
+    OutLattice.Sample(DensityNoise, DensityStepXY, DensityStepZ, Rect.Min.X, Rect.Min.Y, Rect.Width(), Rect.Height(), RectMinZ, RectMaxZ);
+}
+
+int32 FTerrainGeneratorState::ResurfaceColumn(FChunkColumn& Column, EBlock* Blocks, const FDensityLattice& SurfaceLattice, float* Density) const
+{
+    int32 MinZ, MaxZ;
+    GetSurfaceBand(Column, MinZ, MaxZ);
+    SurfaceLattice.InterpolateColumn(Column.X, Column.Y, MinZ, MaxZ, Density);
+
+    // Re-surface the band top-down: solid voxels take the biome layer for their depth below the nearest air,
+    // air open to the sky below the water line floods
+    const FCompiledBiome* Biome = CompiledBiomes ? CompiledBiomes->Find(Column.GetBiomeType()) : nullptr;
+    const float BandDepth = static_cast<float>(SurfaceBandDepth);
+    int32 Depth = 0;
+    int32 TopSolidZ = MinZ - 1;
+
+    for (int32 z = MaxZ - 1; z >= MinZ; --z)
+    {
+        if (Density[z - MinZ] * BandDepth > static_cast<float>(z - Column.Height))
+        {
+            Blocks[z] = Biome ? Biome->GetSurfaceBlock(Depth) : EBlock::Stone;
+            ++Depth;
+            TopSolidZ = FMath::Max(TopSolidZ, z);
+        }
+        else
+        {
+            Blocks[z] = TopSolidZ < MinZ && z <= WaterThreshold ? EBlock::Water : EBlock::Air;
+            Depth = 0;
+        }
+    }
+
+    Column.Height = TopSolidZ;
+    return FMath::Max(0, MaxZ - MinZ);
+}
+
+void FTerrainGeneratorState::ProbeStructureSites(const FIntRect& Rect, TArray<FStructureSite>& OutSites) const
+{
+    TArray<FTerrainSurfaceSample> Samples;
+    QuerySurfaceRegion(Rect, Samples);
+    OutSites.SetNum(Samples.Num(), EAllowShrinking::No);
+    if (Samples.IsEmpty()) return;
+
+    const int32 Width = Rect.Width();
+    TArray<FChunkColumn> Columns;
+    Columns.SetNum(Samples.Num());
+    for (int32 Index = 0; Index < Samples.Num(); ++Index)
+    {
+        Columns[Index] = FChunkColumn(Rect.Min.X + Index % Width, Rect.Min.Y + Index / Width);
+        Columns[Index].SetSurfaceSample(Samples[Index]);
+    }
+
+    // The lattice is world-aligned, so these columns interpolate the same density their own chunk does.
+    // Caves only carve below the top solid block, so they can't change a site.
+    FDensityLattice SurfaceLattice;
+    if (bDensityTerrain && DensityNoise.IsValid())
+    {
+        SampleSurfaceLattice(Rect, Columns, SurfaceLattice);
+    }
+
+    TArray<EBlock, TInlineAllocator<256>> Blocks;
+    Blocks.SetNumUninitialized(ChunkHeight);
+    TArray<float, TInlineAllocator<260>> Density;
+    Density.SetNumUninitialized(ChunkHeight + 3);
+
+    for (int32 Index = 0; Index < Columns.Num(); ++Index)
+    {
+        FChunkColumn& Column = Columns[Index];
+        PopulateColumnBlocks(Column, Blocks);
+        if (!SurfaceLattice.IsEmpty())
+        {
+            ResurfaceColumn(Column, Blocks.GetData(), SurfaceLattice, Density.GetData());
+        }
+
+        FStructureSite& Site = OutSites[Index];
+        Site = FStructureSite();
+        Site.Biome = Column.GetBiomeType();
+        Site.TopSolidZ = Column.Height;
+        if (Site.TopSolidZ >= 0 && Site.TopSolidZ < ChunkHeight - 1)
+        {
+            Site.SurfaceBlock = Blocks[Site.TopSolidZ];
+            Site.SpawnBlock = Blocks[Site.TopSolidZ + 1];
+        }
+    }
+}
+
+int32 FTerrainGeneratorState::GetFoliageStreamSeed(const FIntVector2& ChunkGridPosition) const
+{
+    return Seed + ChunkGridPosition.X * 73856093 ^ ChunkGridPosition.Y * 19349663;
+}
+
+void FTerrainGeneratorState::DecorateChunkWithFoliage(FChunkVoxels& InOutVoxels,
+	const FIntVector2& ChunkGridPosition, const FRandomStream& WorldFoliageStreamBase) const
+{
+	if (InOutVoxels.IsEmpty()) return;
+
+    if (FoliagePlacement == EFoliagePlacement::JitteredGrid)
+    {
+        DecorateChunkOnFoliageGrid(InOutVoxels, ChunkGridPosition, WorldFoliageStreamBase);
+        return;
+    }
+
+    FStructureWriter Writer(InOutVoxels);
+    uint64 SitesEvaluated = 0;
+
+    for (int Y_Local = 0; Y_Local < ChunkSize; ++Y_Local)
+    {
+        for (int X_Local = 0; X_Local < ChunkSize; ++X_Local)
+        {
+            int ColumnIndex = FChunkData::GetColumnIndexFromLocal(X_Local, Y_Local, ChunkSize);
+            if (!InOutVoxels.Columns.IsValidIndex(ColumnIndex)) continue;
+
+            const FChunkColumn& CurrentColumn = InOutVoxels.Columns[ColumnIndex];
+            EBiomeType BiomeType = CurrentColumn.GetBiomeType();
+            const FCompiledBiome* BiomeInfo = CompiledBiomes ? CompiledBiomes->Find(BiomeType) : nullptr;
+
+            if (!BiomeInfo || BiomeInfo->FoliageRules.IsEmpty()) continue;
+
+            // Most columns can't grow anything on their surface block; skip them before seeding a stream
+            const int TopSolidZ = CurrentColumn.Height;
+            if (TopSolidZ < 0 || TopSolidZ >= ChunkHeight - 1) continue;
+            if (!(BiomeInfo->FoliageSurfaceMask & GetBlockMask(InOutVoxels.GetColumnBlock(ColumnIndex, TopSolidZ)))) continue;
+
+            FRandomStream ColumnFoliageDecisionStream;
+            int32 GlobalX = ChunkGridPosition.X * ChunkSize + X_Local;
+            int32 GlobalY = ChunkGridPosition.Y * ChunkSize + Y_Local;
+
+            ColumnFoliageDecisionStream.Initialize(
+                WorldFoliageStreamBase.GetCurrentSeed() ^ GlobalX ^ (GlobalY << 16) ^ (GlobalY >> 16)
+            );
+
+            UFoliageGenerator::AttemptPlaceFoliageAt(
+                Writer,
+                X_Local, Y_Local,
+                BiomeInfo,
+                ColumnFoliageDecisionStream,
+                FoliageStamps.Get()
+            );
+            ++SitesEvaluated;
+        }
+    }
+
+    // Trees rooted within reach of the chunk's sides grow into it as well. Their columns are probed and rolled with
+    // their own chunk's stream, so both chunks place the same tree and each keeps its side of it.
+    const int32 Reach = UFoliageGenerator::MaxStructureReach;
+    const FIntPoint ChunkMin(ChunkGridPosition.X * ChunkSize, ChunkGridPosition.Y * ChunkSize);
+    const FIntPoint ChunkMax = ChunkMin + FIntPoint(ChunkSize);
+    const FIntRect Borders[] = {
+        FIntRect(ChunkMin.X - Reach, ChunkMin.Y - Reach, ChunkMax.X + Reach, ChunkMin.Y),
+        FIntRect(ChunkMin.X - Reach, ChunkMax.Y, ChunkMax.X + Reach, ChunkMax.Y + Reach),
+        FIntRect(ChunkMin.X - Reach, ChunkMin.Y, ChunkMin.X, ChunkMax.Y),
+        FIntRect(ChunkMax.X, ChunkMin.Y, ChunkMax.X + Reach, ChunkMax.Y),
+    };
+
+    TArray<FStructureSite> Sites;
+    for (const FIntRect& Border : Borders)
+    {
+        ProbeStructureSites(Border, Sites);
+        for (int32 SiteIndex = 0; SiteIndex < Sites.Num(); ++SiteIndex)
+        {
+            const FStructureSite& Site = Sites[SiteIndex];
+            const FCompiledBiome* BiomeInfo = CompiledBiomes ? CompiledBiomes->Find(Site.Biome) : nullptr;
+            if (!BiomeInfo || BiomeInfo->FoliageRules.IsEmpty()) continue;
+            if (!(BiomeInfo->FoliageSurfaceMask & GetBlockMask(Site.SurfaceBlock))) continue;
+
+            const int32 GlobalX = Border.Min.X + SiteIndex % Border.Width();
+            const int32 GlobalY = Border.Min.Y + SiteIndex / Border.Width();
+            const FIntVector2 SiteChunk(
+                FMath::FloorToInt(static_cast<float>(GlobalX) / ChunkSize),
+                FMath::FloorToInt(static_cast<float>(GlobalY) / ChunkSize));
+            const FRandomStream ColumnFoliageDecisionStream(GetFoliageStreamSeed(SiteChunk) ^ GlobalX ^ (GlobalY << 16) ^ (GlobalY >> 16));
+
+            UFoliageGenerator::RollFoliageRulesAt(Writer, GlobalX - ChunkMin.X, GlobalY - ChunkMin.Y, Site, BiomeInfo,
+                ColumnFoliageDecisionStream, FoliageStamps.Get());
+            ++SitesEvaluated;
+        }
+    }
+
+    Stats->FoliageSitesEvaluated.fetch_add(SitesEvaluated, std::memory_order_relaxed);
+}
+
+void FTerrainGeneratorState::DecorateChunkOnFoliageGrid(FChunkVoxels& InOutVoxels,
+	const FIntVector2& ChunkGridPosition, const FRandomStream& WorldFoliageStreamBase) const
+{
+    FStructureWriter Writer(InOutVoxels);
+    uint64 SitesEvaluated = 0;
+
+    // Candidates sit in [0, Jitter) of their cell, so neighbouring candidates are at least MinSpacing apart on each axis.
+    // One candidate stands for a whole cell of columns, so each rule fires with the chance at least one of the cell's
+    // columns would have rolled it.
+    const int32 Jitter = FoliageCellSize - FoliageMinSpacing;
+    const float CellArea = static_cast<float>(FoliageCellSize * FoliageCellSize);
+    const int32 Reach = UFoliageGenerator::MaxStructureReach;
+
+    const int32 ChunkMinX = ChunkGridPosition.X * ChunkSize;
+    const int32 ChunkMinY = ChunkGridPosition.Y * ChunkSize;
+    const int32 FirstCellX = FMath::FloorToInt(static_cast<float>(ChunkMinX - Reach) / FoliageCellSize);
+    const int32 FirstCellY = FMath::FloorToInt(static_cast<float>(ChunkMinY - Reach) / FoliageCellSize);
+    const int32 LastCellX = FMath::FloorToInt(static_cast<float>(ChunkMinX + ChunkSize - 1 + Reach) / FoliageCellSize);
+    const int32 LastCellY = FMath::FloorToInt(static_cast<float>(ChunkMinY + ChunkSize - 1 + Reach) / FoliageCellSize);
+
+    auto RollCandidate = [&](const FRandomStream& CellStream, int32 X_Local, int32 Y_Local, const FStructureSite& Site)
+    {
+        const FCompiledBiome* BiomeInfo = CompiledBiomes ? CompiledBiomes->Find(Site.Biome) : nullptr;
+        if (!BiomeInfo || BiomeInfo->FoliageRules.IsEmpty()) return;
+        if (Site.TopSolidZ < 0 || Site.TopSolidZ >= ChunkHeight - 1) return;
+
+        const uint32 SurfaceMask = GetBlockMask(Site.SurfaceBlock);
+        ++SitesEvaluated;
+
+        // 1 - (1 - p)^area saturates towards 1 instead of passing it. Where the rules' chances together still pass 1
+        // they are scaled down alike, so a likely early rule can't starve the ones after it.
+        TArray<float, TInlineAllocator<8>> Chances;
+        Chances.SetNumZeroed(BiomeInfo->FoliageRules.Num());
+        float TotalChance = 0.0f;
+        for (int32 RuleIndex = 0; RuleIndex < BiomeInfo->FoliageRules.Num(); ++RuleIndex)
+        {
+            const FCompiledFoliageRule& Rule = BiomeInfo->FoliageRules[RuleIndex];
+            if (!(Rule.SurfaceMask & SurfaceMask)) continue;
+
+            Chances[RuleIndex] = 1.0f - FMath::Pow(1.0f - Rule.SpawnThreshold, CellArea);
+            TotalChance += Chances[RuleIndex];
+        }
+        const float ChanceScale = TotalChance > 1.0f ? 1.0f / TotalChance : 1.0f;
+
+        // One roll picks at most one rule, earlier rules first as in per-column placement
+        float Roll = CellStream.FRand();
+        for (int32 RuleIndex = 0; RuleIndex < BiomeInfo->FoliageRules.Num(); ++RuleIndex)
+        {
+            const FCompiledFoliageRule& Rule = BiomeInfo->FoliageRules[RuleIndex];
+            if (!(Rule.SurfaceMask & SurfaceMask)) continue;
+
+            const float Chance = Chances[RuleIndex] * ChanceScale;
+            if (Roll < Chance)
+            {
+                FRandomStream FoliageInstanceStream(CellStream.GetCurrentSeed() ^ (int32)Rule.Type);
+                UFoliageGenerator::PlaceFoliageRuleAt(Writer, X_Local, Y_Local, Site, Rule, FoliageInstanceStream, FoliageStamps.Get());
+                break;
+            }
+            Roll -= Chance;
+        }
+    };
+
+    // Candidates just outside the chunk whose structures can reach into it, rolled once the chunk's own are placed
+    struct FOutsideCandidate
+    {
+        FRandomStream CellStream;
+        int32 X_Local;
+        int32 Y_Local;
+    };
+    TArray<FOutsideCandidate, TInlineAllocator<32>> OutsideCandidates;
+
+    for (int32 CellY = FirstCellY; CellY <= LastCellY; ++CellY)
+    {
+        for (int32 CellX = FirstCellX; CellX <= LastCellX; ++CellX)
+        {
+            // Keyed on the world seed and cell only, so every chunk a candidate's structure reaches rolls it the same
+            FRandomStream CellStream(static_cast<int32>(HashCombineFast(::GetTypeHash(Seed), HashCombineFast(::GetTypeHash(CellX), ::GetTypeHash(CellY)))));
+            const int32 X_Local = CellX * FoliageCellSize + CellStream.RandHelper(Jitter) - ChunkMinX;
+            const int32 Y_Local = CellY * FoliageCellSize + CellStream.RandHelper(Jitter) - ChunkMinY;
+            if (X_Local < -Reach || X_Local >= ChunkSize + Reach || Y_Local < -Reach || Y_Local >= ChunkSize + Reach) continue;
+
+            if (!Writer.IsInsideChunk(X_Local, Y_Local))
+            {
+                OutsideCandidates.Add({ CellStream, X_Local, Y_Local });
+                continue;
+            }
+
+            RollCandidate(CellStream, X_Local, Y_Local, Writer.GetSite(X_Local, Y_Local));
+        }
+    }
+
+    // Grass after the structures, so it only grows where a trunk didn't take the spot
+    for (int Y_Local = 0; Y_Local < ChunkSize; ++Y_Local)
+    {
+        for (int X_Local = 0; X_Local < ChunkSize; ++X_Local)
+        {
+            const FChunkColumn& CurrentColumn = InOutVoxels.Columns[FChunkData::GetColumnIndexFromLocal(X_Local, Y_Local, ChunkSize)];
+            const FCompiledBiome* BiomeInfo = CompiledBiomes ? CompiledBiomes->Find(CurrentColumn.GetBiomeType()) : nullptr;
+            if (!BiomeInfo || !BiomeInfo->GrassSurfaceMask) continue;
+
+            const int32 GlobalX = ChunkMinX + X_Local;
+            const int32 GlobalY = ChunkMinY + Y_Local;
+            const FRandomStream ColumnGrassStream(WorldFoliageStreamBase.GetCurrentSeed() ^ GlobalX ^ (GlobalY << 16) ^ (GlobalY >> 16));
+            UFoliageGenerator::AttemptPlaceGrassAt(Writer, X_Local, Y_Local, BiomeInfo, ColumnGrassStream);
+        }
+    }
+
+    // Their own chunk decides them from its voxels; here the site is probed, and only the part reaching in is written
+    TArray<FStructureSite> Sites;
+    for (const FOutsideCandidate& Candidate : OutsideCandidates)
+    {
+        const int32 GlobalX = ChunkMinX + Candidate.X_Local;
+        const int32 GlobalY = ChunkMinY + Candidate.Y_Local;
+        ProbeStructureSites(FIntRect(GlobalX, GlobalY, GlobalX + 1, GlobalY + 1), Sites);
+        RollCandidate(Candidate.CellStream, Candidate.X_Local, Candidate.Y_Local, Sites[0]);
+    }
+
+    Stats->FoliageSitesEvaluated.fetch_add(SitesEvaluated, std::memory_order_relaxed);
+}
@@ -0,0 +1,78 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Structs/BiomeBlend.h"
+
+EBiomeType FBiomeWeights::Pick(float Random01) const
+{
+	float Cumulative = 0.f;
+	for (int32 i = 0; i < Count - 1; ++i)
+	{
+		Cumulative += Weights[i].Weight;
+		if (Random01 < Cumulative) return Weights[i].Biome;
+	}
+	return Weights[Count - 1].Biome;
+}
+
+void FBiomeBlendGrid::Initialize(int32 OriginX, int32 OriginY, int32 SizeX, int32 SizeY, int32 InRadius, int32 InStep)
+{
+	// A radius under one step could fall between nodes and see no biome at all
+	Step = FMath::Max(1, InStep);
+	Radius = FMath::Max(InRadius, Step);
+
+	NodeMinX = FloorToNode(OriginX - Radius);
+	NodeMinY = FloorToNode(OriginY - Radius);
+	NodeCountX = FloorToNode(OriginX + SizeX - 1 + Radius) - NodeMinX + 1;
+	NodeCountY = FloorToNode(OriginY + SizeY - 1 + Radius) - NodeMinY + 1;
+
+	Biomes.SetNumUninitialized(NodeCountX * NodeCountY, EAllowShrinking::No);
+}
+
+void FBiomeBlendGrid::ComputeWeights(int32 GlobalX, int32 GlobalY, FBiomeWeights& OutWeights) const
+{
+	// Separable tent over every node within Radius; it falls to zero just past the radius so weights move smoothly per column
+	const float InvFalloff = 1.f / (Radius + 1);
+
+	const int32 FirstX = FMath::CeilToInt(static_cast<float>(GlobalX - Radius) / Step);
+	const int32 LastX = FloorToNode(GlobalX + Radius);
+	const int32 FirstY = FMath::CeilToInt(static_cast<float>(GlobalY - Radius) / Step);
+	const int32 LastY = FloorToNode(GlobalY + Radius);
+
+	TStaticArray<float, BiomeTypeCount> Accumulated(InPlace, 0.f);
+
+	for (int32 NodeY = FirstY; NodeY <= LastY; ++NodeY)
+	{
+		const float WeightY = 1.f - FMath::Abs(NodeY * Step - GlobalY) * InvFalloff;
+		const int32 RowStart = (NodeY - NodeMinY) * NodeCountX - NodeMinX;
+
+		for (int32 NodeX = FirstX; NodeX <= LastX; ++NodeX)
+		{
+			const float Weight = WeightY * (1.f - FMath::Abs(NodeX * Step - GlobalX) * InvFalloff);
+			Accumulated[static_cast<int32>(Biomes[RowStart + NodeX])] += Weight;
+		}
+	}
+
+	// Keep the heaviest few biomes; anything lighter is noise at the very edge of the kernel
+	OutWeights.Count = 0;
+	for (int32 BiomeIndex = 0; BiomeIndex < BiomeTypeCount; ++BiomeIndex)
+	{
+		const float Weight = Accumulated[BiomeIndex];
+		if (Weight <= 0.f) continue;
+
+		int32 Insert = OutWeights.Count;
+		while (Insert > 0 && OutWeights.Weights[Insert - 1].Weight < Weight) --Insert;
+		if (Insert >= FBiomeWeights::MaxBiomes) continue;
+
+		const int32 Last = FMath::Min(OutWeights.Count, FBiomeWeights::MaxBiomes - 1);
+		for (int32 i = Last; i > Insert; --i)
+		{
+			OutWeights.Weights[i] = OutWeights.Weights[i - 1];
+		}
+		OutWeights.Weights[Insert] = FBiomeWeight{ static_cast<EBiomeType>(BiomeIndex), Weight };
+		OutWeights.Count = FMath::Min(OutWeights.Count + 1, FBiomeWeights::MaxBiomes);
+	}
+
+	float Kept = 0.f;
+	for (int32 i = 0; i < OutWeights.Count; ++i) Kept += OutWeights.Weights[i].Weight;
+	for (int32 i = 0; i < OutWeights.Count; ++i) OutWeights.Weights[i].Weight /= Kept;
+}
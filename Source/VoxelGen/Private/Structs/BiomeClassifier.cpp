@@ -0,0 +1,48 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Structs/BiomeClassifier.h"
+
+template <int32 NumBands>
+void FBiomeClassifier::FBandThresholds<NumBands>::Set(std::initializer_list<float> Thresholds)
+{
+	check(Thresholds.size() == NumBands - 1);
+
+	// Band k is reached only when the value passed every earlier threshold, so each one becomes the running max
+	int32 Index = 0;
+	float RunningMax = -MAX_flt;
+	for (const float Threshold : Thresholds)
+	{
+		RunningMax = FMath::Max(RunningMax, Threshold);
+		Values[Index++] = RunningMax;
+	}
+}
+
+void FBiomeClassifier::Build(const FTemperatureData& Temperature, const FHumidityData& Humidity,
+	const FContinentalnessData& Continentalness, const FErosionData& Erosion, const FPeaksValleysData& PeaksValleys,
+	TFunctionRef<EBiomeType(const FCategorizedBiomeInputs&)> DetermineBiome)
+{
+	TemperatureBands.Set({ Temperature.ColdestValue, Temperature.ColderValue, Temperature.TemperateValue, Temperature.WarmValue });
+	HumidityBands.Set({ Humidity.DryestValue, Humidity.DryValue, Humidity.MediumValue, Humidity.WetValue });
+	ContinentalnessBands.Set({ Continentalness.MushroomFieldsValue, Continentalness.DeepOceanValue, Continentalness.OceanValue,
+		Continentalness.CoastValue, Continentalness.NearInlandValue, Continentalness.MidInlandValue });
+	ErosionBands.Set({ Erosion.E0Value, Erosion.E1Value, Erosion.E2Value, Erosion.E3Value, Erosion.E4Value, Erosion.E5Value });
+	PVBands.Set({ PeaksValleys.ValleysValue, PeaksValleys.LowValue, PeaksValleys.MidValue, PeaksValleys.HighValue });
+
+	for (int32 T = 0; T < NumTemperatureBands; ++T)
+	for (int32 H = 0; H < NumHumidityBands; ++H)
+	for (int32 C = 0; C < NumContinentalnessBands; ++C)
+	for (int32 E = 0; E < NumErosionBands; ++E)
+	for (int32 P = 0; P < NumPVBands; ++P)
+	for (int32 W = 0; W < NumWeirdnessBands; ++W)
+	{
+		const FCategorizedBiomeInputs Inputs(
+			static_cast<ETemperatureType>(T), static_cast<EHumidityType>(H), static_cast<EContinentalnessType>(C),
+			static_cast<EErosionType>(E), static_cast<EPVType>(P),
+			W ? 1.0f : 0.0f); // Any value on the matching side of WeirdnessSplit
+
+		Table[GetTableIndex(T, H, C, E, P, W)] = DetermineBiome(Inputs);
+	}
+
+	bIsBuilt = true;
+}
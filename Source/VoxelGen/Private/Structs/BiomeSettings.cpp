@@ -1,4 +1,71 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 
-#include "Structs/BiomeSettings.h"
\ No newline at end of file
+#include "Structs/BiomeSettings.h"
+
+#include "Engine/DataTable.h"
+
+static uint32 GetBlockMask(const TArray<EBlock>& Blocks)
+{
+	uint32 Mask = 0;
+	for (const EBlock Block : Blocks)
+	{
+		Mask |= GetBlockMask(Block);
+	}
+	return Mask;
+}
+
+void FCompiledBiomeTable::Compile(const UDataTable* BiomesTable)
+{
+	for (int32 BiomeIndex = 0; BiomeIndex < BiomeTypeCount; ++BiomeIndex)
+	{
+		FCompiledBiome& Compiled = Biomes[BiomeIndex];
+		Compiled = FCompiledBiome();
+
+		if (!BiomesTable) continue;
+
+		const EBiomeType BiomeType = static_cast<EBiomeType>(BiomeIndex);
+		const FBiomeSettings* Row = BiomesTable->FindRow<FBiomeSettings>(BiomeTypeToFName(BiomeType), TEXT("Compile Biome Settings"), false);
+		if (!Row)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("No biome DataTable row for %s, columns will fall back to stone"), *BiomeTypeToFName(BiomeType).ToString());
+			continue;
+		}
+
+		for (const FBlockLayer& Layer : Row->Layers)
+		{
+			if (Layer.LayerThickness <= 0) continue;
+
+			const int32 LayerStart = Compiled.SurfaceDepth;
+			Compiled.SurfaceDepth += Layer.LayerThickness;
+
+			if (!Compiled.SurfaceLayers.IsEmpty() && Compiled.SurfaceLayers.Last().Block == Layer.BlockType)
+			{
+				Compiled.SurfaceLayers.Last().End = Compiled.SurfaceDepth;
+			}
+			else
+			{
+				Compiled.SurfaceLayers.Emplace(Layer.BlockType, LayerStart, Compiled.SurfaceDepth);
+			}
+		}
+
+		Compiled.HeightOffset = Row->HeightOffset;
+		for (const FFoliageSpawnRule& Rule : Row->FoliageRules)
+		{
+			FCompiledFoliageRule& CompiledRule = Compiled.FoliageRules.AddDefaulted_GetRef();
+			CompiledRule.Type = Rule.Type;
+			CompiledRule.SurfaceMask = GetBlockMask(Rule.AllowedSurfaceBlocks);
+			CompiledRule.SpawnThreshold = FMath::Clamp(Rule.SpawnChancePerColumn, 0.f, 1.f);
+			CompiledRule.VariantThreshold = FMath::Clamp(Rule.VariantChance, 0.f, 1.f);
+			CompiledRule.MinHeight = Rule.MinHeight;
+			CompiledRule.MaxHeight = Rule.MaxHeight;
+			Compiled.FoliageSurfaceMask |= CompiledRule.SurfaceMask;
+		}
+
+		// Grass never draws when its chance is 0, so it only widens the mask when it can actually spawn
+		Compiled.GrassThreshold = FMath::Clamp(Row->SurfaceGrassChance, 0.f, 1.f);
+		Compiled.GrassSurfaceMask = Row->SurfaceGrassChance > 0 ? GetBlockMask(Row->GrassSpawnableOn) : 0;
+		Compiled.FoliageSurfaceMask |= Compiled.GrassSurfaceMask;
+		Compiled.bIsValid = true;
+	}
+}
@@ -0,0 +1,63 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Structs/ChunkEditDelta.h"
+
+#include "Structs/ChunkVoxels.h"
+
+void FChunkEditDelta::Apply(FChunkVoxels& InOutVoxels) const
+{
+	const int32 NumBlocks = InOutVoxels.NumColumns() * InOutVoxels.GetChunkHeight();
+	for (const TPair<int32, EBlock>& Edit : Edits)
+	{
+		if (Edit.Key >= 0 && Edit.Key < NumBlocks)
+		{
+			InOutVoxels.SetBlockAt(Edit.Key, Edit.Value);
+		}
+	}
+}
+
+FArchive& operator<<(FArchive& Ar, FChunkEditDelta& Delta)
+{
+	int32 NumEdits = Delta.Edits.Num();
+	Ar << NumEdits;
+
+	if (Ar.IsLoading())
+	{
+		Delta.Edits.Reset();
+		if (NumEdits < 0 || static_cast<int64>(NumEdits) * (sizeof(int32) + sizeof(uint8)) > Ar.TotalSize() - Ar.Tell())
+		{
+			Ar.SetError();
+			return Ar;
+		}
+		Delta.Edits.Reserve(NumEdits);
+
+		for (int32 i = 0; i < NumEdits && !Ar.IsError(); ++i)
+		{
+			int32 BlockIndex = 0;
+			uint8 Block = 0;
+			Ar << BlockIndex << Block;
+
+			if (Block >= BlockTypeCount)
+			{
+				Ar.SetError();
+				break;
+			}
+			Delta.Edits.Add(BlockIndex, static_cast<EBlock>(Block));
+		}
+
+		if (Ar.IsError())
+		{
+			Delta.Edits.Reset();
+		}
+		return Ar;
+	}
+
+	for (const TPair<int32, EBlock>& Edit : Delta.Edits)
+	{
+		int32 BlockIndex = Edit.Key;
+		uint8 Block = static_cast<uint8>(Edit.Value);
+		Ar << BlockIndex << Block;
+	}
+	return Ar;
+}
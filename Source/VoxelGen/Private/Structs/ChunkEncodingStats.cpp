@@ -0,0 +1,29 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Structs/ChunkEncodingStats.h"
+
+#include "Structs/EncodedChunkVoxels.h"
+
+void FChunkEncodingStats::Reset()
+{
+	ChunksEncoded = 0;
+	ChunksDecoded = 0;
+	RawBytesEncoded = 0;
+	EncodedBytes = 0;
+	EncodeCycles = 0;
+	DecodeCycles = 0;
+}
+
+void FChunkEncodingStats::AddEncoded(const FEncodedChunkVoxels& Encoded)
+{
+	ChunksEncoded.fetch_add(1, std::memory_order_relaxed);
+	RawBytesEncoded.fetch_add(Encoded.GetRawBlockSize(), std::memory_order_relaxed);
+	EncodedBytes.fetch_add(Encoded.GetEncodedBlockSize(), std::memory_order_relaxed);
+}
+
+double FChunkEncodingStats::GetCompressionRatio() const
+{
+	const uint64 Encoded = EncodedBytes.load(std::memory_order_relaxed);
+	return Encoded > 0 ? static_cast<double>(RawBytesEncoded.load(std::memory_order_relaxed)) / Encoded : 0.0;
+}
@@ -0,0 +1,89 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Structs/ChunkVoxels.h"
+
+void FChunkVoxels::Initialize(int32 InChunkSize, int32 InChunkHeight)
+{
+	ChunkSize = FMath::Max(0, InChunkSize);
+	ChunkHeight = FMath::Max(0, InChunkHeight);
+
+	Columns.Reset();
+	Columns.SetNum(ChunkSize * ChunkSize);
+	PackedBlocks.Reset();
+	bPacked = false;
+	Blocks.Reset();
+	Blocks.SetNumZeroed(ChunkSize * ChunkSize * ChunkHeight);
+	static_assert(static_cast<int32>(EBlock::Air) == 0, "Zeroed voxels are air");
+
+	FChunkSection EmptySection;
+	EmptySection.State = EChunkSectionState::Empty;
+	Sections.Init(EmptySection, FMath::DivideAndRoundUp(ChunkHeight, SectionHeight));
+	bSectionsValid = true;
+}
+
+void FChunkVoxels::Reset()
+{
+	ChunkSize = 0;
+	ChunkHeight = 0;
+	Columns.Reset();
+	Blocks.Reset();
+	PackedBlocks.Reset();
+	bPacked = false;
+	Sections.Reset();
+	bSectionsValid = false;
+}
+
+void FChunkVoxels::UpdateSections()
+{
+	Sections.SetNum(FMath::DivideAndRoundUp(ChunkHeight, SectionHeight));
+	const int32 NumBlocks = ChunkSize * ChunkSize * ChunkHeight;
+
+	for (int32 SectionIndex = 0; SectionIndex < Sections.Num(); ++SectionIndex)
+	{
+		const int32 MinZ = SectionIndex * SectionHeight;
+		const int32 MaxZ = FMath::Min(MinZ + SectionHeight, ChunkHeight);
+
+		FChunkSection& Section = Sections[SectionIndex];
+		Section.Block = NumBlocks > 0 ? GetBlockAt(MinZ) : EBlock::Air;
+		bool bUniform = true;
+
+		// Stops at the first block that differs, so mixed sections near the surface cost a few reads
+		for (int32 ColumnIndex = 0; bUniform && ColumnIndex < Columns.Num(); ++ColumnIndex)
+		{
+			const int32 ColumnStart = ColumnIndex * ChunkHeight;
+			for (int32 z = MinZ; z < MaxZ; ++z)
+			{
+				if (GetBlockAt(ColumnStart + z) != Section.Block)
+				{
+					bUniform = false;
+					break;
+				}
+			}
+		}
+
+		Section.State = !bUniform ? EChunkSectionState::Mixed
+			: Section.Block == EBlock::Air ? EChunkSectionState::Empty
+			: EChunkSectionState::Uniform;
+	}
+	bSectionsValid = true;
+}
+
+void FChunkVoxels::Pack()
+{
+	if (bPacked) return;
+
+	PackedBlocks.Build(Blocks);
+	Blocks.Empty();
+	bPacked = true;
+}
+
+void FChunkVoxels::Unpack()
+{
+	if (!bPacked) return;
+
+	Blocks.SetNumUninitialized(PackedBlocks.Num());
+	PackedBlocks.Unpack(Blocks);
+	PackedBlocks.Reset();
+	bPacked = false;
+}
@@ -0,0 +1,40 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Structs/ColumnSpans.h"
+
+void FColumnSpans::Add(EBlock Block, int32 Start, int32 End)
+{
+	if (End <= Start || Block == EBlock::Air) return;
+
+	if (!Spans.IsEmpty())
+	{
+		FColumnSpan& Last = Spans.Last();
+		checkSlow(Start >= Last.End);
+
+		if (Block == Last.Block && Start == Last.End)
+		{
+			Last.End = End;
+			return;
+		}
+	}
+
+	Spans.Emplace(Block, Start, End);
+}
+
+void FColumnSpans::Fill(TArrayView<EBlock> OutBlocks) const
+{
+	EBlock* Blocks = OutBlocks.GetData();
+	const int32 Height = OutBlocks.Num();
+
+	int32 z = 0;
+	for (const FColumnSpan& Span : Spans)
+	{
+		const int32 SpanStart = FMath::Clamp(Span.Start, 0, Height);
+		const int32 SpanEnd = FMath::Clamp(Span.End, 0, Height);
+
+		for (; z < SpanStart; ++z) Blocks[z] = EBlock::Air;
+		for (; z < SpanEnd; ++z) Blocks[z] = Span.Block;
+	}
+	for (; z < Height; ++z) Blocks[z] = EBlock::Air;
+}
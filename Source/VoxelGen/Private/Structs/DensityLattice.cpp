@@ -0,0 +1,111 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Structs/DensityLattice.h"
+
+#include "Structs/TerrainNoiseSource.h"
+
+void FDensityLattice::Sample(const FTerrainNoiseSource& Noise, int32 InStepXY, int32 InStepZ,
+	int32 OriginX, int32 OriginY, int32 SizeX, int32 SizeY, int32 MinZ, int32 MaxZ)
+{
+	StepXY = FMath::Max(1, InStepXY);
+	StepZ = FMath::Max(4, Align(InStepZ, 4));
+
+	if (SizeX <= 0 || SizeY <= 0 || MaxZ <= MinZ)
+	{
+		Nodes.Reset();
+		LatticeSizeX = LatticeSizeY = LatticeSizeZ = 0;
+		return;
+	}
+
+	LatticeMinX = FloorToLattice(OriginX, StepXY);
+	LatticeMinY = FloorToLattice(OriginY, StepXY);
+	LatticeMinZ = FloorToLattice(MinZ, StepZ);
+	LatticeSizeX = FloorToLattice(OriginX + SizeX - 1, StepXY) - LatticeMinX + 2;
+	LatticeSizeY = FloorToLattice(OriginY + SizeY - 1, StepXY) - LatticeMinY + 2;
+	LatticeSizeZ = FloorToLattice(MaxZ - 1, StepZ) - LatticeMinZ + 2;
+
+	// Padded so the last node column can be read a full vector at a time
+	Nodes.SetNumUninitialized(NumNodes() + 4, EAllowShrinking::No);
+
+	float* Node = Nodes.GetData();
+	for (int32 ly = 0; ly < LatticeSizeY; ++ly)
+	{
+		const float GlobalY = (LatticeMinY + ly) * StepXY;
+		for (int32 lx = 0; lx < LatticeSizeX; ++lx)
+		{
+			const float GlobalX = (LatticeMinX + lx) * StepXY;
+			for (int32 lz = 0; lz < LatticeSizeZ; ++lz)
+			{
+				*Node++ = Noise.GetNoise3D(GlobalX, GlobalY, (LatticeMinZ + lz) * StepZ);
+			}
+		}
+	}
+	FMemory::Memzero(Node, 4 * sizeof(float));
+}
+
+void FDensityLattice::InterpolateColumn(int32 GlobalX, int32 GlobalY, int32 MinZ, int32 MaxZ, float* OutValues) const
+{
+	if (MaxZ <= MinZ) return;
+
+	const int32 CellX = FloorToLattice(GlobalX, StepXY);
+	const int32 CellY = FloorToLattice(GlobalY, StepXY);
+	const float InvStepXY = 1.f / StepXY;
+	const VectorRegister4Float AlphaX = VectorSetFloat1((GlobalX - CellX * StepXY) * InvStepXY);
+	const VectorRegister4Float AlphaY = VectorSetFloat1((GlobalY - CellY * StepXY) * InvStepXY);
+
+	// Only the node rows the requested heights fall between
+	const int32 FirstNode = FloorToLattice(MinZ, StepZ) - LatticeMinZ;
+	const int32 NodeCount = FloorToLattice(MaxZ - 1, StepZ) - LatticeMinZ + 2 - FirstNode;
+	checkSlow(FirstNode >= 0 && FirstNode + NodeCount <= LatticeSizeZ);
+
+	const float* Row0 = Nodes.GetData() + ((CellY - LatticeMinY) * LatticeSizeX + (CellX - LatticeMinX)) * LatticeSizeZ + FirstNode;
+	const float* Row1 = Row0 + LatticeSizeX * LatticeSizeZ;
+	const int32 NextX = LatticeSizeZ;
+
+	// Bilinear pass over the four surrounding node columns, four nodes at a time
+	TArray<float, TInlineAllocator<68>> Column;
+	Column.SetNumUninitialized(Align(NodeCount, 4));
+	for (int32 i = 0; i < NodeCount; i += 4)
+	{
+		const VectorRegister4Float N00 = VectorLoad(Row0 + i);
+		const VectorRegister4Float N10 = VectorLoad(Row0 + NextX + i);
+		const VectorRegister4Float N01 = VectorLoad(Row1 + i);
+		const VectorRegister4Float N11 = VectorLoad(Row1 + NextX + i);
+		const VectorRegister4Float Near = VectorMultiplyAdd(VectorSubtract(N10, N00), AlphaX, N00);
+		const VectorRegister4Float Far = VectorMultiplyAdd(VectorSubtract(N11, N01), AlphaX, N01);
+		VectorStore(VectorMultiplyAdd(VectorSubtract(Far, Near), AlphaY, Near), Column.GetData() + i);
+	}
+
+	// Linear pass along z. StepZ is a multiple of 4, so every aligned group of four heights shares one cell.
+	const float InvStepZ = 1.f / StepZ;
+	const VectorRegister4Float LaneOffsets = MakeVectorRegisterFloat(0.f, 1.f, 2.f, 3.f);
+	const int32 BaseZ = (LatticeMinZ + FirstNode) * StepZ;
+
+	for (int32 z = MinZ & ~3; z < MaxZ; z += 4)
+	{
+		const int32 Local = z - BaseZ;
+		const int32 Cell = Local / StepZ;
+		const float CellOffset = static_cast<float>(Local - Cell * StepZ);
+
+		const VectorRegister4Float Alpha = VectorMultiply(VectorAdd(VectorSetFloat1(CellOffset), LaneOffsets), VectorSetFloat1(InvStepZ));
+		const VectorRegister4Float Low = VectorSetFloat1(Column[Cell]);
+		const VectorRegister4Float High = VectorSetFloat1(Column[Cell + 1]);
+		const VectorRegister4Float Value = VectorMultiplyAdd(VectorSubtract(High, Low), Alpha, Low);
+
+		// The first group can start up to three heights below MinZ; OutValues is indexed from MinZ
+		if (z >= MinZ)
+		{
+			VectorStore(Value, OutValues + (z - MinZ));
+		}
+		else
+		{
+			alignas(16) float Lanes[4];
+			VectorStoreAligned(Value, Lanes);
+			for (int32 Lane = MinZ - z; Lane < 4; ++Lane)
+			{
+				OutValues[z + Lane - MinZ] = Lanes[Lane];
+			}
+		}
+	}
+}
@@ -0,0 +1,70 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Structs/EncodedChunkVoxels.h"
+
+#include "Structs/ChunkVoxels.h"
+
+namespace
+{
+	template <typename FGetBlock>
+	void EncodeRuns(int32 NumBlocks, FGetBlock GetBlock, TArray<FBlockRun>& OutRuns)
+	{
+		int32 i = 0;
+		while (i < NumBlocks)
+		{
+			const EBlock Block = GetBlock(i);
+			const int32 Start = i;
+			while (i < NumBlocks && i - Start < MAX_uint16 && GetBlock(i) == Block) ++i;
+
+			OutRuns.Emplace(Block, static_cast<uint16>(i - Start));
+		}
+	}
+}
+
+void FEncodedChunkVoxels::Encode(const FChunkVoxels& Voxels)
+{
+	Reset();
+
+	ChunkSize = Voxels.GetChunkSize();
+	ChunkHeight = Voxels.GetChunkHeight();
+	Columns = Voxels.Columns;
+
+	const int32 NumBlocks = Voxels.NumColumns() * ChunkHeight;
+	if (Voxels.IsPacked())
+	{
+		EncodeRuns(NumBlocks, [&Voxels](int32 Index) { return Voxels.GetBlockAt(Index); }, Runs);
+	}
+	else
+	{
+		const EBlock* Blocks = Voxels.Blocks.GetData();
+		EncodeRuns(NumBlocks, [Blocks](int32 Index) { return Blocks[Index]; }, Runs);
+	}
+
+	// Held for as long as the chunk stays unloaded, so drop the growth slack
+	Runs.Shrink();
+}
+
+void FEncodedChunkVoxels::Decode(FChunkVoxels& OutVoxels) const
+{
+	OutVoxels.Initialize(ChunkSize, ChunkHeight);
+	OutVoxels.Columns = Columns;
+
+	EBlock* Blocks = OutVoxels.Blocks.GetData();
+	int32 i = 0;
+	for (const FBlockRun& Run : Runs)
+	{
+		FMemory::Memset(Blocks + i, static_cast<uint8>(Run.Block), Run.Length);
+		i += Run.Length;
+	}
+	check(i == OutVoxels.Blocks.Num());
+	OutVoxels.UpdateSections();
+}
+
+void FEncodedChunkVoxels::Reset()
+{
+	Columns.Reset();
+	Runs.Reset();
+	ChunkSize = 0;
+	ChunkHeight = 0;
+}
@@ -0,0 +1,74 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Structs/FoliageStamps.h"
+
+#include "Objects/FoliageGenerator.h"
+#include "Structs/BiomeSettings.h"
+#include "Structs/StructurePlacement.h"
+
+void FFoliageStamp::Place(FStructureWriter& Writer, const FIntVector& BaseLocalPosition) const
+{
+	for (const FStampSpan& Span : Spans)
+	{
+		const int32 StartZ = BaseLocalPosition.Z + Span.Z;
+		Writer.SetSpan(BaseLocalPosition.X + Span.X, BaseLocalPosition.Y + Span.Y, StartZ, StartZ + Span.Length, Span.Block);
+	}
+}
+
+void FFoliageStampLibrary::Build(int32 Seed, const FCompiledBiomeTable& Biomes)
+{
+	Shapes.Reset();
+
+	for (int32 BiomeIndex = 0; BiomeIndex < BiomeTypeCount; ++BiomeIndex)
+	{
+		const FCompiledBiome* Biome = Biomes.Find(static_cast<EBiomeType>(BiomeIndex));
+		if (!Biome) continue;
+
+		for (const FCompiledFoliageRule& Rule : Biome->FoliageRules)
+		{
+			if (Rule.Type == EFoliageType::GrassPlant) continue;
+
+			// Cacti have no large variant
+			const int32 SizeVariants = Rule.Type == EFoliageType::Cactus ? 1 : 2;
+			for (int32 Height = Rule.MinHeight; Height <= Rule.MaxHeight; ++Height)
+			{
+				for (int32 Large = 0; Large < SizeVariants; ++Large)
+				{
+					const uint32 Key = GetShapeKey(Rule.Type, Height, Large != 0);
+					if (Shapes.Contains(Key)) continue;
+
+					TArray<FFoliageStamp>& Variants = Shapes.Add(Key);
+					Variants.SetNum(VariantsPerShape);
+					for (int32 Variant = 0; Variant < VariantsPerShape; ++Variant)
+					{
+						FRandomStream Stream(HashCombineFast(::GetTypeHash(Seed), HashCombineFast(Key, Variant)));
+						UFoliageGenerator::BakeStamp(Rule.Type, Height, Large != 0, Stream, Variants[Variant]);
+					}
+				}
+			}
+		}
+	}
+}
+
+const FFoliageStamp* FFoliageStampLibrary::Find(EFoliageType Type, int32 Height, bool bLargeVariant, uint32 Hash) const
+{
+	if (Type == EFoliageType::Cactus) bLargeVariant = false;
+
+	const TArray<FFoliageStamp>* Variants = Shapes.Find(GetShapeKey(Type, Height, bLargeVariant));
+	return Variants ? &(*Variants)[Hash % VariantsPerShape] : nullptr;
+}
+
+SIZE_T FFoliageStampLibrary::GetAllocatedSize() const
+{
+	SIZE_T Size = Shapes.GetAllocatedSize();
+	for (const TPair<uint32, TArray<FFoliageStamp>>& Pair : Shapes)
+	{
+		Size += Pair.Value.GetAllocatedSize();
+		for (const FFoliageStamp& Stamp : Pair.Value)
+		{
+			Size += Stamp.Spans.GetAllocatedSize();
+		}
+	}
+	return Size;
+}
@@ -0,0 +1,95 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Structs/PalettedBlocks.h"
+
+void FPalettedBlocks::Build(TArrayView<const EBlock> Blocks)
+{
+	Reset();
+	NumBlocks = Blocks.Num();
+	if (NumBlocks == 0) return;
+
+	// Palette index per block value; EBlock is one byte
+	TStaticArray<uint8, 256> PaletteIndices(InPlace, MAX_uint8);
+	for (const EBlock Block : Blocks)
+	{
+		uint8& PaletteIndex = PaletteIndices[static_cast<uint8>(Block)];
+		if (PaletteIndex == MAX_uint8)
+		{
+			PaletteIndex = static_cast<uint8>(Palette.Add(Block));
+		}
+	}
+
+	int32 Bits = 1;
+	while ((1 << Bits) < Palette.Num()) Bits *= 2;
+	SetWidth(Bits);
+
+	Words.SetNumZeroed(FMath::DivideAndRoundUp(NumBlocks, 32 / BitsPerBlock));
+	for (int32 Index = 0; Index < NumBlocks; ++Index)
+	{
+		SetIndex(Words, Index, PaletteIndices[static_cast<uint8>(Blocks[Index])]);
+	}
+}
+
+void FPalettedBlocks::Reset()
+{
+	Palette.Reset();
+	Words.Empty();
+	NumBlocks = 0;
+	SetWidth(1);
+}
+
+void FPalettedBlocks::Unpack(TArrayView<EBlock> OutBlocks) const
+{
+	check(OutBlocks.Num() == NumBlocks);
+	for (int32 Index = 0; Index < NumBlocks; ++Index)
+	{
+		OutBlocks[Index] = Get(Index);
+	}
+}
+
+void FPalettedBlocks::Set(int32 Index, EBlock Block)
+{
+	SetIndex(Words, Index, FindOrAddPaletteIndex(Block));
+}
+
+int32 FPalettedBlocks::FindOrAddPaletteIndex(EBlock Block)
+{
+	const int32 Found = Palette.Find(Block);
+	if (Found != INDEX_NONE) return Found;
+
+	if (Palette.Num() >= (1 << BitsPerBlock))
+	{
+		Repack(BitsPerBlock * 2);
+	}
+	return Palette.Add(Block);
+}
+
+void FPalettedBlocks::SetWidth(int32 InBitsPerBlock)
+{
+	check(InBitsPerBlock == 1 || InBitsPerBlock == 2 || InBitsPerBlock == 4 || InBitsPerBlock == 8);
+	BitsPerBlock = InBitsPerBlock;
+	IndexMask = (1u << BitsPerBlock) - 1;
+	EntriesPerWordShift = FMath::FloorLog2(32 / BitsPerBlock);
+	EntriesPerWordMask = (32 / BitsPerBlock) - 1;
+}
+
+void FPalettedBlocks::Repack(int32 NewBitsPerBlock)
+{
+	TArray<uint8> Indices;
+	Indices.SetNumUninitialized(NumBlocks);
+	for (int32 Index = 0; Index < NumBlocks; ++Index)
+	{
+		const uint32 Word = Words[Index >> EntriesPerWordShift];
+		Indices[Index] = static_cast<uint8>((Word >> ((Index & EntriesPerWordMask) * BitsPerBlock)) & IndexMask);
+	}
+
+	SetWidth(NewBitsPerBlock);
+	TArray<uint32> NewWords;
+	NewWords.SetNumZeroed(FMath::DivideAndRoundUp(NumBlocks, 32 / BitsPerBlock));
+	for (int32 Index = 0; Index < NumBlocks; ++Index)
+	{
+		SetIndex(NewWords, Index, Indices[Index]);
+	}
+	Words = MoveTemp(NewWords);
+}
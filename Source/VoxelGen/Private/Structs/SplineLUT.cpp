@@ -0,0 +1,52 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Structs/SplineLUT.h"
+
+#include "Curves/CurveFloat.h"
+
+void FSplineLUT::Bake(const UCurveFloat* Curve, int32 Resolution)
+{
+	Reset();
+	if (!Curve) return;
+
+	Resolution = FMath::Max(Resolution, 2);
+
+	// Inputs are normalized to [0, 1], but keep any keys outside of it so clamping matches the curve's extrapolation
+	float KeyMinTime = 0.f;
+	float KeyMaxTime = 1.f;
+	Curve->GetTimeRange(KeyMinTime, KeyMaxTime);
+	MinTime = FMath::Min(0.f, KeyMinTime);
+	MaxTime = FMath::Max(1.f, KeyMaxTime);
+
+	const float Step = (MaxTime - MinTime) / (Resolution - 1);
+	InvStep = 1.f / Step;
+
+	Samples.SetNumUninitialized(Resolution);
+	for (int32 i = 0; i < Resolution; ++i)
+	{
+		Samples[i] = Curve->GetFloatValue(MinTime + i * Step);
+	}
+}
+
+void FSplineLUT::Reset()
+{
+	Samples.Empty();
+	MinTime = 0.f;
+	MaxTime = 1.f;
+	InvStep = 0.f;
+}
+
+float FSplineLUT::MeasureMaxError(const UCurveFloat* Curve, int32 NumTestSamples) const
+{
+	if (!Curve || !IsBaked() || NumTestSamples < 2) return 0.f;
+
+	float MaxError = 0.f;
+	const float Step = (MaxTime - MinTime) / (NumTestSamples - 1);
+	for (int32 i = 0; i < NumTestSamples; ++i)
+	{
+		const float Time = MinTime + i * Step;
+		MaxError = FMath::Max(MaxError, FMath::Abs(Evaluate(Time) - Curve->GetFloatValue(Time)));
+	}
+	return MaxError;
+}
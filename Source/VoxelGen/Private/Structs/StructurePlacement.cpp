@@ -0,0 +1,64 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Structs/StructurePlacement.h"
+
+#include "Structs/ChunkVoxels.h"
+
+FStructureWriter::FStructureWriter(FChunkVoxels& InVoxels)
+	: Voxels(InVoxels), ChunkSize(InVoxels.GetChunkSize()), ChunkHeight(InVoxels.GetChunkHeight())
+{
+	// Writes straight into the flat buffer, so generation hands it unpacked voxels and rebuilds the section flags after
+	checkSlow(!InVoxels.IsPacked());
+	InVoxels.InvalidateSections();
+}
+
+void FStructureWriter::SetBlock(int32 LocalX, int32 LocalY, int32 LocalZ, EBlock Block)
+{
+	if (LocalZ < 0 || LocalZ >= ChunkHeight || !IsInsideChunk(LocalX, LocalY)) return;
+
+	EBlock& Target = Voxels.Blocks[Voxels.GetBlockIndex(LocalX, LocalY, LocalZ)];
+	if (Target == EBlock::Air)
+	{
+		Target = Block;
+	}
+}
+
+void FStructureWriter::SetSpan(int32 LocalX, int32 LocalY, int32 StartZ, int32 EndZ, EBlock Block)
+{
+	if (!IsInsideChunk(LocalX, LocalY)) return;
+
+	StartZ = FMath::Max(StartZ, 0);
+	EndZ = FMath::Min(EndZ, ChunkHeight);
+
+	EBlock* ColumnBlocks = &Voxels.Blocks[Voxels.GetBlockIndex(LocalX, LocalY, 0)];
+	for (int32 z = StartZ; z < EndZ; ++z)
+	{
+		if (ColumnBlocks[z] == EBlock::Air)
+		{
+			ColumnBlocks[z] = Block;
+		}
+	}
+}
+
+EBlock FStructureWriter::GetBlock(int32 LocalX, int32 LocalY, int32 LocalZ) const
+{
+	if (!IsInsideChunk(LocalX, LocalY) || LocalZ < 0 || LocalZ >= ChunkHeight) return EBlock::Air;
+	return Voxels.GetBlock(LocalX, LocalY, LocalZ);
+}
+
+FStructureSite FStructureWriter::GetSite(int32 LocalX, int32 LocalY) const
+{
+	const int32 ColumnIndex = LocalX + LocalY * ChunkSize;
+	const FChunkColumn& Column = Voxels.Columns[ColumnIndex];
+
+	FStructureSite Site;
+	Site.Biome = Column.GetBiomeType();
+	Site.TopSolidZ = Column.Height;
+	if (Site.TopSolidZ >= 0 && Site.TopSolidZ < ChunkHeight - 1)
+	{
+		Site.SurfaceBlock = Voxels.GetColumnBlock(ColumnIndex, Site.TopSolidZ);
+		Site.SpawnBlock = Voxels.GetColumnBlock(ColumnIndex, Site.TopSolidZ + 1);
+	}
+	return Site;
+}
@@ -0,0 +1,92 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Structs/TerrainFieldCache.h"
+
+void FTerrainFieldCache::SetCapacity(int32 InMaxTiles)
+{
+	FWriteScopeLock WriteLock(Lock);
+	MaxTiles = FMath::Max(1, InMaxTiles);
+	EvictLeastRecentlyUsed();
+}
+
+int32 FTerrainFieldCache::Num() const
+{
+	FReadScopeLock ReadLock(Lock);
+	return Tiles.Num();
+}
+
+void FTerrainFieldCache::Invalidate()
+{
+	FWriteScopeLock WriteLock(Lock);
+	Tiles.Empty();
+	++Epoch;
+}
+
+FTerrainFieldCache::FTileRef FTerrainFieldCache::GetTile(const FIntVector2& TileCoordinates, FGenerateFields GenerateFields)
+{
+	uint32 StartEpoch;
+	{
+		FReadScopeLock ReadLock(Lock);
+		if (const TUniquePtr<FEntry>* Entry = Tiles.Find(TileCoordinates))
+		{
+			Touch(**Entry);
+			return (*Entry)->Tile;
+		}
+		StartEpoch = Epoch;
+	}
+
+	// Generated outside the lock; two threads missing the same tile both generate it and the first one in wins
+	TSharedPtr<FTerrainFieldTile, ESPMode::ThreadSafe> NewTile = MakeShared<FTerrainFieldTile, ESPMode::ThreadSafe>();
+	NewTile->TileCoordinates = TileCoordinates;
+	NewTile->Fields.Initialize(TileCoordinates.X * TileSize, TileCoordinates.Y * TileSize, TileSize, TileSize);
+	GenerateFields(NewTile->Fields);
+
+	FWriteScopeLock WriteLock(Lock);
+	if (const TUniquePtr<FEntry>* Entry = Tiles.Find(TileCoordinates))
+	{
+		Touch(**Entry);
+		return (*Entry)->Tile;
+	}
+
+	// Settings changed while generating; hand the tile to this caller but don't publish it
+	if (StartEpoch != Epoch)
+	{
+		return NewTile;
+	}
+
+	TUniquePtr<FEntry>& Entry = Tiles.Add(TileCoordinates, MakeUnique<FEntry>());
+	Entry->Tile = NewTile;
+	Touch(*Entry);
+	EvictLeastRecentlyUsed();
+
+	return NewTile;
+}
+
+void FTerrainFieldCache::Touch(FEntry& Entry)
+{
+	// Relaxed is enough, the stamp only orders evictions
+	Entry.LastUsed.store(++UseCounter, std::memory_order_relaxed);
+}
+
+void FTerrainFieldCache::EvictLeastRecentlyUsed()
+{
+	// Called with the write lock held; capacity is small enough that a scan beats keeping a list in sync
+	while (Tiles.Num() > MaxTiles)
+	{
+		const FIntVector2* Oldest = nullptr;
+		uint64 OldestUse = MAX_uint64;
+		for (const TPair<FIntVector2, TUniquePtr<FEntry>>& Pair : Tiles)
+		{
+			const uint64 Use = Pair.Value->LastUsed.load(std::memory_order_relaxed);
+			if (Use < OldestUse)
+			{
+				OldestUse = Use;
+				Oldest = &Pair.Key;
+			}
+		}
+
+		const FIntVector2 OldestKey = *Oldest;
+		Tiles.Remove(OldestKey);
+	}
+}
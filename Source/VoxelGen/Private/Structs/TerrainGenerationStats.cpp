@@ -0,0 +1,24 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Structs/TerrainGenerationStats.h"
+
+void FTerrainGenerationStats::Reset()
+{
+	NoiseCycles = 0;
+	SplineCycles = 0;
+	HeightCycles = 0;
+	ClassificationCycles = 0;
+	BlendCycles = 0;
+	PopulateCycles = 0;
+	FoliageCycles = 0;
+	DensityCycles = 0;
+	FieldColumnsGenerated = 0;
+	ChunksGenerated = 0;
+	DensityVoxelsEvaluated = 0;
+	DensityNodesSampled = 0;
+	FoliageSitesEvaluated = 0;
+	SectionsEmpty = 0;
+	SectionsUniform = 0;
+	SectionsMixed = 0;
+}
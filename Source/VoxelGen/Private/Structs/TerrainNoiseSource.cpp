@@ -0,0 +1,136 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "Structs/TerrainNoiseSource.h"
+
+#include "Structs/NoiseOctaveSettingsAsset.h"
+#include "Structs/TerrainData.h"
+
+void FTerrainNoiseSource::Setup(const UNoiseOctaveSettingsAsset* Settings, int32 WorldSeed, int32 InSampleStep)
+{
+	bIsValid = Settings != nullptr;
+	SampleStep = FMath::Max(1, InSampleStep);
+	if (!bIsValid) return;
+
+	// Same configuration UFastNoiseWrapper::SetupFastNoise applies, so results match the wrapper bit for bit
+	Noise.SetNoiseType(static_cast<FastNoise::NoiseType>(Settings->NoiseType));
+	Noise.SetSeed(WorldSeed + Settings->SeedOffset);
+	Noise.SetFrequency(Settings->Frequency);
+	Noise.SetInterp(static_cast<FastNoise::Interp>(Settings->Interpolation));
+	Noise.SetFractalType(static_cast<FastNoise::FractalType>(Settings->FractalType));
+	Noise.SetFractalOctaves(Settings->Octaves);
+	Noise.SetFractalLacunarity(Settings->Lacunarity);
+	Noise.SetFractalGain(Settings->Gain);
+}
+
+void FTerrainNoiseSource::SampleRegion(const FTerrainFieldBuffer& Fields, TArray<float>& OutValues) const
+{
+	if (!bIsValid)
+	{
+		// Missing noise behaves like a flat 0 field
+		FMemory::Memzero(OutValues.GetData(), OutValues.Num() * sizeof(float));
+		return;
+	}
+
+	if (SampleStep > 1)
+	{
+		SampleCoarse(Fields, OutValues);
+	}
+	else
+	{
+		SampleFull(Fields, OutValues);
+	}
+}
+
+void FTerrainNoiseSource::MeasureCoarseError(const FTerrainFieldBuffer& Fields, float& OutMaxError, float& OutMeanError) const
+{
+	OutMaxError = 0.f;
+	OutMeanError = 0.f;
+	if (!bIsValid || SampleStep <= 1 || Fields.Num() == 0) return;
+
+	TArray<float> Exact;
+	TArray<float> Interpolated;
+	Exact.SetNumUninitialized(Fields.Num());
+	Interpolated.SetNumUninitialized(Fields.Num());
+	SampleFull(Fields, Exact);
+	SampleCoarse(Fields, Interpolated);
+
+	double SumError = 0.0;
+	for (int32 i = 0; i < Fields.Num(); ++i)
+	{
+		const float Error = FMath::Abs(Exact[i] - Interpolated[i]);
+		OutMaxError = FMath::Max(OutMaxError, Error);
+		SumError += Error;
+	}
+	OutMeanError = SumError / Fields.Num();
+}
+
+void FTerrainNoiseSource::SampleFull(const FTerrainFieldBuffer& Fields, TArray<float>& OutValues) const
+{
+	float* Out = OutValues.GetData();
+	for (int32 y = 0; y < Fields.SizeY; ++y)
+	{
+		const int32 GlobalY = Fields.OriginY + y;
+		for (int32 x = 0; x < Fields.SizeX; ++x)
+		{
+			*Out++ = Noise.GetNoise(Fields.OriginX + x, GlobalY);
+		}
+	}
+}
+
+void FTerrainNoiseSource::SampleCoarse(const FTerrainFieldBuffer& Fields, TArray<float>& OutValues) const
+{
+	const int32 Step = SampleStep;
+
+	// Lattice nodes sit on world multiples of the step, so neighbouring regions interpolate from the same samples
+	auto FloorToLattice = [Step](int32 Global) { return FMath::FloorToInt(static_cast<float>(Global) / Step); };
+
+	const int32 LatticeMinX = FloorToLattice(Fields.OriginX);
+	const int32 LatticeMinY = FloorToLattice(Fields.OriginY);
+	const int32 LatticeSizeX = FloorToLattice(Fields.OriginX + Fields.SizeX - 1) - LatticeMinX + 2;
+	const int32 LatticeSizeY = FloorToLattice(Fields.OriginY + Fields.SizeY - 1) - LatticeMinY + 2;
+
+	TArray<float> Lattice;
+	Lattice.SetNumUninitialized(LatticeSizeX * LatticeSizeY);
+	float* Node = Lattice.GetData();
+	for (int32 ly = 0; ly < LatticeSizeY; ++ly)
+	{
+		const int32 GlobalY = (LatticeMinY + ly) * Step;
+		for (int32 lx = 0; lx < LatticeSizeX; ++lx)
+		{
+			*Node++ = Noise.GetNoise((LatticeMinX + lx) * Step, GlobalY);
+		}
+	}
+
+	// Bilinear weights along one axis repeat every step, so they are computed once per row and column
+	const float InvStep = 1.f / Step;
+	TArray<int32, TInlineAllocator<64>> CellX;
+	TArray<float, TInlineAllocator<64>> AlphaX;
+	CellX.SetNumUninitialized(Fields.SizeX);
+	AlphaX.SetNumUninitialized(Fields.SizeX);
+	for (int32 x = 0; x < Fields.SizeX; ++x)
+	{
+		const int32 GlobalX = Fields.OriginX + x;
+		const int32 Cell = FloorToLattice(GlobalX);
+		CellX[x] = Cell - LatticeMinX;
+		AlphaX[x] = (GlobalX - Cell * Step) * InvStep;
+	}
+
+	float* Out = OutValues.GetData();
+	for (int32 y = 0; y < Fields.SizeY; ++y)
+	{
+		const int32 GlobalY = Fields.OriginY + y;
+		const int32 CellY = FloorToLattice(GlobalY);
+		const float AlphaY = (GlobalY - CellY * Step) * InvStep;
+		const float* Row0 = Lattice.GetData() + (CellY - LatticeMinY) * LatticeSizeX;
+		const float* Row1 = Row0 + LatticeSizeX;
+
+		for (int32 x = 0; x < Fields.SizeX; ++x)
+		{
+			const int32 Cell = CellX[x];
+			const float Top = FMath::Lerp(Row0[Cell], Row0[Cell + 1], AlphaX[x]);
+			const float Bottom = FMath::Lerp(Row1[Cell], Row1[Cell + 1], AlphaX[x]);
+			*Out++ = FMath::Lerp(Top, Bottom, AlphaY);
+		}
+	}
+}
@@ -0,0 +1,79 @@
+﻿#include "Objects/TerrainGenerator.h"
+#include "Misc/AutomationTest.h"
+#include "UObject/Package.h"
+#include <cmath>
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FBiomeClassifierMatchesDecisionTreeTest, "VoxelGen.Biomes.ClassifierMatchesDecisionTree",
+	EAutomationTestFlags::EditorContext | EAutomationTestFlags::EngineFilter)
+
+bool FBiomeClassifierMatchesDecisionTreeTest::RunTest(const FString& Parameters)
+{
+	// The shipped default thresholds, so the result doesn't depend on what a level has tuned
+	UTerrainGenerator* Generator = NewObject<UTerrainGenerator>(GetTransientPackage());
+	Generator->TemperatureThresholds = FTemperatureData();
+	Generator->HumidityThresholds = FHumidityData();
+	Generator->ContinentalnessThresholds = FContinentalnessData();
+	Generator->ErosionThresholds = FErosionData();
+	Generator->PeaksValleysThresholds = FPeaksValleysData();
+	Generator->BuildBiomeClassifier();
+
+	const FBiomeClassifier& Classifier = Generator->BiomeClassifier;
+	const FTemperatureData& Temperature = Generator->TemperatureThresholds;
+	const FHumidityData& Humidity = Generator->HumidityThresholds;
+	const FContinentalnessData& Continentalness = Generator->ContinentalnessThresholds;
+	const FErosionData& Erosion = Generator->ErosionThresholds;
+	const FPeaksValleysData& PeaksValleys = Generator->PeaksValleysThresholds;
+
+	// Banding right at, just below and just above every threshold, plus a sweep past both ends of [-1, 1]
+	TArray<float> Probes;
+	for (float Threshold : {
+		Temperature.ColdestValue, Temperature.ColderValue, Temperature.TemperateValue, Temperature.WarmValue,
+		Humidity.DryestValue, Humidity.DryValue, Humidity.MediumValue, Humidity.WetValue,
+		Continentalness.MushroomFieldsValue, Continentalness.DeepOceanValue, Continentalness.OceanValue,
+		Continentalness.CoastValue, Continentalness.NearInlandValue, Continentalness.MidInlandValue,
+		Erosion.E0Value, Erosion.E1Value, Erosion.E2Value, Erosion.E3Value, Erosion.E4Value, Erosion.E5Value,
+		PeaksValleys.ValleysValue, PeaksValleys.LowValue, PeaksValleys.MidValue, PeaksValleys.HighValue,
+		FBiomeClassifier::WeirdnessSplit })
+	{
+		Probes.Append({ Threshold, std::nextafter(Threshold, -MAX_flt), std::nextafter(Threshold, MAX_flt) });
+	}
+	for (int32 i = -1536; i <= 1536; ++i)
+	{
+		Probes.Add(i / 1024.f);
+	}
+
+	int32 BandMismatches = 0;
+	for (const float Value : Probes)
+	{
+		BandMismatches += Classifier.BandTemperature(Value) != Generator->CategorizeTemperature(Value);
+		BandMismatches += Classifier.BandHumidity(Value) != Generator->CategorizeHumidity(Value);
+		BandMismatches += Classifier.BandContinentalness(Value) != Generator->CategorizeContinentalness(Value);
+		BandMismatches += Classifier.BandErosion(Value) != Generator->CategorizeErosion(Value);
+		BandMismatches += Classifier.BandPV(Value) != Generator->CategorizePV(Value);
+	}
+	TestEqual(TEXT("Bands that disagree with the categorize functions"), BandMismatches, 0);
+
+	// Whole classification against the tree for random inputs drawn from the probe set
+	int32 BiomeMismatches = 0;
+	FRandomStream Stream(0x5EED);
+	for (int32 i = 0; i < 16384; ++i)
+	{
+		const float T = Probes[Stream.RandHelper(Probes.Num())];
+		const float H = Probes[Stream.RandHelper(Probes.Num())];
+		const float C = Probes[Stream.RandHelper(Probes.Num())];
+		const float E = Probes[Stream.RandHelper(Probes.Num())];
+		const float P = Probes[Stream.RandHelper(Probes.Num())];
+		const float W = Probes[Stream.RandHelper(Probes.Num())];
+
+		const FCategorizedBiomeInputs Inputs(Generator->CategorizeTemperature(T), Generator->CategorizeHumidity(H),
+			Generator->CategorizeContinentalness(C), Generator->CategorizeErosion(E), Generator->CategorizePV(P), W);
+		BiomeMismatches += Classifier.Classify(T, H, C, E, P, W) != Generator->DetermineBiomeType(Inputs);
+	}
+	TestEqual(TEXT("Biomes that disagree with the decision tree"), BiomeMismatches, 0);
+
+	return true;
+}
+
+#endif
@@ -6,16 +6,35 @@
 #include "Structs/ChunkMeshData.h"
 #include "GameFramework/Actor.h"
 #include "Structs/BlockSettings.h"
-#include "Structs/ChunkColumn.h"
+#include "Structs/ChunkEditDelta.h"
+#include "Structs/ChunkVoxels.h"
 #include "ChunkBase.generated.h"
 
 enum class EDirection;
-enum class EBlock;
+enum class EBlock : uint8;
 
 class UProceduralMeshComponent;
+class UInstancedStaticMeshComponent;
 class UFastNoiseWrapper;
 class AChunkWorld;
 
+// Instanced cross-plane blocks of one type. Built with the mesh, then kept index-aligned with the type's component.
+struct FCrossPlaneInstances
+{
+	TArray<FTransform> Transforms;
+	TArray<float> Variants;
+	TArray<FIntVector> Positions;
+	TMap<FIntVector, int32> IndexByPosition;
+};
+
+// A player block change made while mesh tasks were reading the voxels, applied once they are done
+struct FDeferredBlockChange
+{
+	FIntVector Position;
+	EBlock Block;
+	bool bDestroy;
+};
+
 UCLASS(Abstract)
 class VOXELGEN_API AChunkBase : public AActor
 {
@@ -25,14 +44,27 @@ public:
 	AChunkBase();
 	
 	void RegenerateMesh();
+	// Starts a mesh task, or runs another one once the current task is done
 	void RegenerateMeshAsync();
 	void ClearMesh();
 
-	TArray<FChunkColumn> GetColumns() const { return ChunkColumns; }
-	void SetColumns(const TArray<FChunkColumn>& NewColumns);
+	// Mesh tasks read this chunk's voxels and its side neighbours' border blocks, so writes wait until none runs
+	bool CanWriteVoxels() const;
+	// Applies the block changes deferred by CanWriteVoxels with one remesh; false while writes are still blocked
+	bool ApplyDeferredBlockChanges();
+
+	const FChunkVoxels& GetVoxels() const { return Voxels; }
+	void SetVoxels(const FChunkVoxels& NewVoxels);
+	void SetVoxels(FChunkVoxels&& NewVoxels);
 
 	void SpawnBlock(const FIntVector& LocalChunkBlockPosition, EBlock BlockType);
 	void DestroyBlock(const FIntVector& LocalChunkBlockPosition);
+
+	// Every block the player changed, so the chunk can be rebuilt by generating it and replaying them
+	const FChunkEditDelta& GetEdits() const { return Edits; }
+	void SetEdits(const FChunkEditDelta& NewEdits) { Edits = NewEdits; }
+	void SetEdits(FChunkEditDelta&& NewEdits) { Edits = MoveTemp(NewEdits); }
+	bool IsModified() const { return !Edits.IsEmpty(); }
 	
 	void SetParentWorld(AChunkWorld* World) { ParentWorld = World; }
 
@@ -59,6 +91,13 @@ protected:
 	bool ShouldRenderFace(const FIntVector& Position) const;
 	bool ShouldRenderFace(int X, int Y, int Z) const;
 
+	// Flags of a section of this chunk, or of the loaded neighbour at ChunkOffset; mixed past the top and bottom
+	// of the world or when the neighbour isn't loaded
+	FChunkSection GetSectionAt(int32 SectionIndex, const FIntVector2& ChunkOffset = FIntVector2(0, 0)) const;
+
+	// Removes the block's instance without touching the chunk mesh; false when the block isn't instanced
+	bool RemoveCrossPlaneInstance(const FIntVector& Position, EBlock BlockType);
+
 	FIntVector GetPositionInDirection(EDirection Direction, const FIntVector& Position) const;
 	void SetBlockAtPosition(const FIntVector& Position, EBlock BlockType);
 
@@ -70,6 +109,8 @@ protected:
 
 	// Update the adjacent chunk if the block is at the edge of the chunk
 	void UpdateAdjacentChunk(const FIntVector& LocalEdgeBlockPosition) const;
+	// Remeshes the neighbours of the edge blocks changed by SetBlockAtPosition, once all writes are done
+	void UpdateAdjacentChunks();
 	TArray<FIntVector> GetEdgeOffsets(const FIntVector& LocalEdgeBlockPosition) const;
 
 	FChunkMeshData& GetMeshDataForBlock(EBlock BlockType);
@@ -79,6 +120,13 @@ protected:
 private:
 	void ApplyMesh();
 
+	// Write one player change and return whether the chunk mesh has to be rebuilt
+	bool WriteSpawnedBlock(const FIntVector& LocalChunkBlockPosition, EBlock BlockType);
+	bool WriteDestroyedBlock(const FIntVector& LocalChunkBlockPosition);
+	void DeferBlockChange(const FIntVector& LocalChunkBlockPosition, EBlock BlockType, bool bDestroy);
+	void ApplyCrossPlaneInstances();
+	UInstancedStaticMeshComponent* GetCrossPlaneComponent(EBlock BlockType);
+
 public:
 	UPROPERTY(VisibleAnywhere, Category = "Chunk")
 	FIntVector2 ChunkPosition;
@@ -95,6 +143,9 @@ public:
 	int LeavesVertexCount = 0;
 	int GrassVertexCount = 0;
 
+	// Filled by GenerateMesh for blocks with an InstanceMesh, handed to the components by ApplyMesh
+	TMap<EBlock, FCrossPlaneInstances> CrossPlaneInstanceData;
+
 protected:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Chunk|Data")
 	TObjectPtr<UDataTable> BlockDataTable;
@@ -102,8 +153,15 @@ protected:
 	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = "Components")
 	TObjectPtr<UProceduralMeshComponent> Mesh;
 
-	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = "Chunk|Columns")
-	TArray<FChunkColumn> ChunkColumns;
+	// One per instanced cross-plane block type, created on first use
+	UPROPERTY(VisibleAnywhere, Category = "Components")
+	TMap<EBlock, TObjectPtr<UInstancedStaticMeshComponent>> CrossPlaneComponents;
+
+	// Instances currently shown by CrossPlaneComponents, game thread only
+	TMap<EBlock, FCrossPlaneInstances> CrossPlaneInstances;
+
+	// Blocks and column metadata; read by mesh tasks, so only written when CanWriteVoxels
+	FChunkVoxels Voxels;
 	
 	// Material properties
 	UPROPERTY(EditAnywhere, Category = "Chunk|Materials")
@@ -136,7 +194,14 @@ protected:
 
 private:
 	bool bIsMeshInitialized = false;
-	bool bCanChangeBlocks = true;
+	// Set when a remesh is asked for while a mesh task runs
+	bool bRemeshRequested = false;
+
+	TArray<FDeferredBlockChange> DeferredBlockChanges;
+	// Edge blocks changed since the last UpdateAdjacentChunks
+	TArray<FIntVector> ChangedEdgeBlocks;
+
+	FChunkEditDelta Edits;
 
 	
 };
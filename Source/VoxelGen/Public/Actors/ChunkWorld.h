@@ -2,13 +2,27 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "Structs/ChunkEditDelta.h"
+#include "Structs/ChunkEncodingStats.h"
+#include "Structs/ChunkVoxels.h"
+#include "Structs/EncodedChunkVoxels.h"
 #include "ChunkWorld.generated.h"
 
-struct FChunkColumn;
 struct FBiomeWeight;
 class AChunkBase;
 class AVoxelGenerationCharacter;
+class FChunkRegionStore;
 class UTerrainGenerator;
+struct FChunkRecordRead;
+struct FChunkRecordWrite;
+
+// A modified chunk held by the saved-chunk cache while unloaded
+struct FSavedChunk
+{
+    FEncodedChunkVoxels Voxels;
+    // Unload order; the smallest is evicted first
+    uint64 LastUsed = 0;
+};
 
 UCLASS()
 class VOXELGEN_API AChunkWorld : public AActor
@@ -19,7 +33,14 @@ public:
     AChunkWorld();
 
     const TMap<FIntVector2, TObjectPtr<AChunkBase>>& GetChunksData() const { return ChunksData; }
-    void NotifyMeshTaskCompleted() { --RunningMeshTasks; }
+    void NotifyMeshTaskStarted() { ++RunningMeshTasks; }
+    // Called on the game thread once the chunk's mesh is applied; its voxels and its neighbours' can be written again
+    void NotifyMeshTaskCompleted(AChunkBase* Chunk);
+    // The chunk has player block changes waiting for mesh tasks to finish
+    void QueueDeferredBlockChanges(const FIntVector2& ChunkCoordinates) { ChunksWithDeferredBlockChanges.Add(ChunkCoordinates); }
+
+    // Called on the game thread once a background generation task has produced a chunk's voxels
+    void OnChunkVoxelsGenerated(const FIntVector2& ChunkCoordinates, uint32 InGenerationId, FChunkVoxels&& Voxels);
 
     UFUNCTION(BlueprintCallable)
     void RegenerateWorld();
@@ -27,6 +48,11 @@ public:
     UFUNCTION(BlueprintPure)
     UTerrainGenerator* GetTerrainGenerator() const { return TerrainGenerator; }
 
+    // Encode and decode totals for the saved-chunk cache since the world started
+    const FChunkEncodingStats& GetSavedChunkStats() const { return SavedChunkStats; }
+    // Bytes currently held in memory by unloaded chunks, columns and runs
+    SIZE_T GetSavedChunksAllocatedSize() const;
+    void LogSavedChunkStats() const;
 
 protected:
     virtual void BeginPlay() override;
@@ -41,21 +67,47 @@ private:
     void UpdateChunksForGeneration();
     void UpdateChunksData(); 
     void ProcessChunksMeshGeneration();
+    void ProcessChunksDataGeneration();
 
     // Chunk Management
     bool IsPlayerChunkUpdated();
     AChunkBase* TryRestoreSavedChunk(const FIntVector2& ChunkCoordinates);
     AChunkBase* GetExistingChunk(const FIntVector2& ChunkCoordinates) const;
-    AChunkBase* CreateAndInitializeChunk(const FIntVector2& ChunkCoordinates);
+    AChunkBase* CreateAndInitializeChunk(const FIntVector2& ChunkCoordinates, FChunkVoxels&& Voxels);
+    void QueueChunkGeneration(const FIntVector2& ChunkCoordinates);
+    bool IsChunkDataPending(const FIntVector2& ChunkCoordinates) const;
+    bool AreNeighbourChunksReady(const FIntVector2& ChunkCoordinates) const;
     AChunkBase* SpawnChunkActorAt(const FIntVector2& ChunkCoordinates);
+    void FlushDeferredBlockChanges();
     AChunkBase* LoadChunkAtPosition(const FIntVector2& ChunkCoordinates);
     void DestroyChunkActor(const FIntVector2& ChunkCoordinates);
 
+    // Saved-chunk cache
+    void SaveChunk(const FIntVector2& ChunkCoordinates, const AChunkBase& Chunk);
+    bool TakeSavedChunk(const FIntVector2& ChunkCoordinates, FEncodedChunkVoxels& OutEncoded);
+    // Drops the least recently unloaded chunks until the cache fits its budget; their edits stay in UnloadedChunkEdits,
+    // so regenerating them rebuilds the same voxels
+    void EvictSavedChunksOverBudget();
+    void ClearSavedChunks();
+
+    // Region files, one set per seed and chunk layout. The store being replaced drains its writes in the background.
+    void OpenRegionStore();
+    // Starts whatever the chunk needs from the region files before it can be generated: learning whether its region
+    // has a record for it, then reading the record. False when there is nothing to wait for.
+    bool RequestChunkRecord(const FIntVector2& ChunkCoordinates);
+    void OnChunkRecordRead(const FIntVector2& ChunkCoordinates, uint32 InGenerationId, FChunkRecordRead&& Record);
+    // Queues the edits of every loaded modified chunk for writing; unloaded ones were written when they unloaded
+    void PersistWorld();
+    // Drops the edits and saved voxels of chunks past LoadDistance plus RecordCacheMargin, along with region tables
+    // none of the kept chunks are in. Their edits are in the region files already and are read again on return.
+    void ForgetDistantChunks();
+
     // Helper Functions
     void SortVisibleChunksByDistance();
     void UnPauseGameIfChunksLoadingComplete() const;
     bool IsWithinLoadDistance(const FIntVector2& ChunkCoordinates) const;
     bool IsWithinDrawDistance(const FIntVector2& ChunkCoordinates) const;
+    bool IsWithinLoadSquare(const FIntVector2& ChunkCoordinates) const;
 
 public:
     UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Settings|Chunk World", meta = (ClampMin = "0", UIMin = "0"))
@@ -69,6 +121,22 @@ private:
     UPROPERTY(EditAnywhere, Category = "Performance", meta = (ClampMin = "1", UIMin = "1"))
     int32 MaxConcurrentMeshTasks = FPlatformMisc::NumberOfCores();
 
+    UPROPERTY(EditAnywhere, Category = "Performance", meta = (ClampMin = "1", UIMin = "1"))
+    int32 MaxConcurrentGenerationTasks = FPlatformMisc::NumberOfCores();
+
+    // Memory the saved-chunk cache may hold; past it, the least recently unloaded chunks are dropped and regenerated with their edits
+    UPROPERTY(EditAnywhere, Category = "Performance|Memory", meta = (ClampMin = "0", UIMin = "0", Units = "Megabytes"))
+    int32 SavedChunkCacheBudgetMB = 64;
+
+    // Chunks this far past LoadDistance keep their edits and saved voxels in memory; past it they are only kept
+    // in the region files, so what the world holds is bounded by the load radius
+    UPROPERTY(EditAnywhere, Category = "Performance|Memory", meta = (ClampMin = "0", UIMin = "0"))
+    int32 RecordCacheMargin = 2;
+
+    // Palette-packs loaded chunks; meshing then decodes every block read, trading mesh time for a larger resident radius
+    UPROPERTY(EditAnywhere, Category = "Performance|Memory")
+    bool bPackLoadedChunks = false;
+
     // Components
     UPROPERTY(EditAnywhere, Category = "Components")
     TObjectPtr<UTerrainGenerator> TerrainGenerator;
@@ -78,9 +146,32 @@ private:
 
     // Runtime Data
     TMap<FIntVector2, TObjectPtr<AChunkBase>> ChunksData;
-    TMap<FIntVector2, TArray<FChunkColumn>> SavedChunkColumns;
+    // Unloaded chunks the player modified, run-length encoded so coming back into LoadDistance skips generation.
+    // Unmodified chunks are dropped on unload and generated again from the seed.
+    TMap<FIntVector2, FSavedChunk> SavedChunks;
+    // Edits of modified chunks that aren't loaded, replayed when they are generated again
+    TMap<FIntVector2, FChunkEditDelta> UnloadedChunkEdits;
+    SIZE_T SavedChunkBytes = 0;
+    uint64 SavedChunkUseCounter = 0;
+
+    FChunkEncodingStats SavedChunkStats;
+    uint64 ChunksDropped = 0;
+    uint64 ChunksEvicted = 0;
+    uint64 ChunksReplayed = 0;
+
+    // Edits of every chunk the player modified, kept across sessions
+    TSharedPtr<FChunkRegionStore, ESPMode::ThreadSafe> RegionStore;
+    // Chunks waiting on the region files, for their region's record presence or their own record
+    TSet<FIntVector2> ChunksReadingRecords;
     TMap<FIntVector2, TObjectPtr<AChunkBase>> ChunksPendingGenerationMap;
 
+    // Loaded chunks holding player block changes deferred while mesh tasks read their voxels
+    TSet<FIntVector2> ChunksWithDeferredBlockChanges;
+
+    // Chunks waiting for a generation task slot, nearest first, and chunks whose task is running
+    TArray<FIntVector2> ChunkDataGenerationQueue;
+    TSet<FIntVector2> ChunksGeneratingData;
+
     TArray<FIntVector2> VisibleChunks;
     FIntVector2 CurrentPlayerChunk;
 
@@ -93,5 +184,10 @@ private:
 
     // State Tracking
     bool bWorldInitialized = false;
+    bool bVisibleChunksDirty = false;
     std::atomic<int32> RunningMeshTasks = 0;
+    int32 RunningGenerationTasks = 0;
+
+    // Bumped on regeneration so results of tasks started for the old world are discarded
+    uint32 GenerationId = 0;
 };
\ No newline at end of file
@@ -20,6 +20,10 @@ protected:
 	virtual void GenerateMesh() override;
 
 private:
+	// Meshes the shell of a section filled with one cube block, leaving out the sides other sections cover
+	void MeshUniformSection(int32 SectionIndex, int32 MinZ, int32 MaxZ);
+	void MeshBlock(const FIntVector& CurrentBlockPos);
+
 	void CreateCubePlanes(const FIntVector& CurrentBlockPos, EBlock Block, const FBlockSettings& BlockSettings);
 	
 	void CreateFace(EDirection Direction, const FIntVector& Position, EBlock BlockType, const FBlockSettings& BlockProperties);
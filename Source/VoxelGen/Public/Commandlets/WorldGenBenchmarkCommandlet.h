@@ -0,0 +1,46 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "WorldGenBenchmarkCommandlet.generated.h"
+
+class UTerrainGenerator;
+struct FChunkEncodingStats;
+
+/**
+ * Generates an N x N chunk region headlessly, single- and multi-threaded, and writes the throughput,
+ * per-stage timings, saved-chunk encoding and peak memory as JSON. Fails when surface queries disagree
+ * with the generated columns.
+ *
+ * UnrealEditor-Cmd VoxelGen.uproject -run=WorldGenBenchmark -nullrhi
+ *     -Preset=/Game/Noise/NGP_Default.NGP_Default -Biomes=/Game/Data/DT_Biomes.DT_Biomes
+ *     [-Generator=/Game/BP_TerrainGenerator.BP_TerrainGenerator_C] [-Seed=1000] [-Size=16]
+ *     [-ChunkSize=16] [-ChunkHeight=256] [-Output=Saved/Benchmark.json]
+ */
+UCLASS()
+class VOXELGEN_API UWorldGenBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UWorldGenBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+private:
+	// Generates every chunk of the region and returns the wall time in seconds
+	double RunPass(UTerrainGenerator* Generator, int32 RegionSize, bool bMultiThreaded) const;
+
+	// Compares QuerySurface and QuerySurfaceRegion with the generated columns over the region, biome borders
+	// included. Returns the number of mismatched columns; OutBorderColumns counts columns next to another biome.
+	int32 RunSurfaceConsistencyPass(UTerrainGenerator* Generator, int32 RegionSize, int32& OutBorderColumns) const;
+
+	// Generates the region again and run-length encodes and decodes every chunk as the saved-chunk cache does
+	void RunEncodingPass(UTerrainGenerator* Generator, int32 RegionSize, FChunkEncodingStats& OutStats) const;
+
+	// Appends one pass's results as a JSON object
+	void WritePassJson(FString& Json, const TCHAR* Name, const UTerrainGenerator* Generator, double Seconds,
+		int32 RegionSize, int32 ChunkSize, int32 NumThreads) const;
+};
@@ -0,0 +1,26 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/AsyncWork.h"
+#include "Objects/TerrainGeneratorState.h"
+
+class AChunkWorld;
+
+// Generates, populates and decorates the voxels of one chunk off the game thread from a generator snapshot,
+// then hands the finished voxels back to the world on the game thread.
+class FChunkGenerationAsync : public FNonAbandonableTask
+{
+	
+public:
+	FChunkGenerationAsync(AChunkWorld* InWorld, FTerrainGeneratorStatePtr InGeneratorState,
+		const FIntVector2& InChunkCoordinates, uint32 InGenerationId);
+
+	static TStatId GetStatId();
+	void DoWork();
+
+private:
+	TWeakObjectPtr<AChunkWorld> WorldPtr;
+	FTerrainGeneratorStatePtr GeneratorState;
+	FIntVector2 ChunkCoordinates;
+	uint32 GenerationId;
+};
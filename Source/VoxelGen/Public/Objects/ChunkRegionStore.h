@@ -0,0 +1,132 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/BitArray.h"
+#include "Misc/Optional.h"
+#include "Structs/ChunkEditDelta.h"
+#include "Tasks/Pipe.h"
+
+class IFileHandle;
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+// What the world persists for one chunk to rebuild it from the seed: the player's edits to replay over the voxels
+// generation gives it. Chunks the player never edited have no record.
+struct FChunkRecordWrite
+{
+	FIntVector2 ChunkCoordinates;
+	FChunkEditDelta Edits;
+};
+
+struct FChunkRecordRead
+{
+	bool bFound = false;
+	FChunkEditDelta Edits;
+};
+
+// Persistent chunk records in region files of RegionSize x RegionSize chunks. Each file starts with an offset table,
+// one entry per chunk pointing at its edits, followed by compressed payloads. A rewrite appends the new payload and
+// repoints its entry, so files grow until the compactor rewrites them with only live payloads.
+// Reads decompress straight out of a memory mapping of the file. All file work runs in order on one background pipe,
+// so the game thread only queues work and gets read results back through a callback on the game thread.
+// Which chunks have a record is kept on the game thread per region, so chunks without one never wait for a read.
+// Destroying the store waits for its queued work.
+class VOXELGEN_API FChunkRegionStore : public TSharedFromThis<FChunkRegionStore, ESPMode::ThreadSafe>
+{
+public:
+	static constexpr int32 RegionSize = 32;
+
+	// File work starts once Previous completes, so a store replacing one on the same files never races its writes
+	explicit FChunkRegionStore(const FString& InDirectory, const UE::Tasks::FTask& InPrevious = UE::Tasks::FTask());
+	~FChunkRegionStore();
+
+	void Write(TArray<FChunkRecordWrite>&& Records);
+	void Read(const FIntVector2& ChunkCoordinates, TUniqueFunction<void(FChunkRecordRead&&)>&& OnRead);
+
+	// Game thread. Whether the chunk has a record, or unset until its region's table has been loaded
+	TOptional<bool> HasRecord(const FIntVector2& ChunkCoordinates) const;
+	// Game thread. Loads the table of the chunk's region once in the background and calls OnLoaded on the game thread
+	// when HasRecord can answer for it, right away if it already can
+	void LoadRecordPresence(const FIntVector2& ChunkCoordinates, TUniqueFunction<void()>&& OnLoaded);
+
+	// Blocks until every queued write and read has run; for shutdown only
+	void Flush();
+	// Completes once everything queued so far has run, without blocking; for handing the files to a new store
+	UE::Tasks::FTask Drain();
+
+	// Unmaps and forgets the tables of regions with no chunk in KeepChunks (Max exclusive); they are loaded again
+	// from their files on next use
+	void ReleaseRegions(const FIntRect& KeepChunks);
+
+	const FString& GetDirectory() const { return Directory; }
+
+private:
+	struct FRegionPayload
+	{
+		uint32 Offset = 0;
+		uint32 Size = 0;
+	};
+
+	struct FRegionEntry
+	{
+		FRegionPayload Edits;
+	};
+
+	struct FRegion
+	{
+		FString Path;
+		TArray<FRegionEntry> Entries;
+		int64 FileSize = 0;
+		// Bytes of payloads the table still points at; the rest of the file past the header is dead
+		int64 LiveBytes = 0;
+
+		// Dropped before every write and mapped again on the next read
+		TUniquePtr<IMappedFileHandle> MappedFile;
+		TUniquePtr<IMappedFileRegion> MappedRegion;
+	};
+
+	// Game thread side of a region: a bit per chunk with a record
+	struct FRegionPresence
+	{
+		TBitArray<> Records;
+		bool bLoaded = false;
+		TArray<TUniqueFunction<void()>> OnLoaded;
+	};
+
+	static FIntVector2 GetRegionCoordinates(const FIntVector2& ChunkCoordinates);
+	static int32 GetEntryIndex(const FIntVector2& ChunkCoordinates);
+
+	// Queues file work on the pipe behind Previous
+	template <typename TaskBodyType>
+	UE::Tasks::FTask Launch(const TCHAR* DebugName, TaskBodyType&& TaskBody);
+
+	FRegionPresence& FindOrAddPresence(const FIntVector2& RegionCoordinates);
+	void OnRecordPresenceLoaded(const FIntVector2& RegionCoordinates, TBitArray<>&& Records);
+
+	// Pipe only from here on
+	FRegion& GetRegion(const FIntVector2& RegionCoordinates);
+	void LoadRegionTable(FRegion& Region) const;
+	bool MapRegion(FRegion& Region) const;
+	void UnmapRegion(FRegion& Region) const;
+
+	void WriteRecords(const FIntVector2& RegionCoordinates, TArray<FChunkRecordWrite>& Records);
+	// Compresses ScratchBuffer onto the end of the file and points Payload at it
+	bool AppendPayload(IFileHandle& File, FRegion& Region, FRegionPayload& Payload);
+	void ReadRecord(const FIntVector2& ChunkCoordinates, FChunkRecordRead& OutRecord);
+	// Decompresses one payload out of the mapping into ScratchBuffer
+	bool ReadPayload(FRegion& Region, const FRegionPayload& Payload);
+	// Rewrites the file with only live payloads once dead ones take more space than they do
+	void CompactIfNeeded(FRegion& Region);
+
+	FString Directory;
+	UE::Tasks::FPipe Pipe;
+	UE::Tasks::FTask Previous;
+
+	// Game thread only
+	TMap<FIntVector2, FRegionPresence> Presence;
+
+	// Pipe only
+	TMap<FIntVector2, TUniquePtr<FRegion>> Regions;
+	// Reused for every payload, the pipe runs one task at a time
+	TArray<uint8> ScratchBuffer;
+};
@@ -6,8 +6,12 @@
 #include "VoxelGen/Enums.h"
 #include "FoliageGenerator.generated.h"
 
-struct FChunkColumn;
-struct FBiomeSettings;
+struct FCompiledBiome;
+struct FCompiledFoliageRule;
+struct FStructureSite;
+struct FStructureWriter;
+struct FFoliageStamp;
+struct FFoliageStampLibrary;
 
 UCLASS()
 class VOXELGEN_API UFoliageGenerator : public UObject
@@ -16,32 +20,63 @@ class VOXELGEN_API UFoliageGenerator : public UObject
 
 public:
 	UFoliageGenerator();
+
+	// Columns a canopy or cactus arm reaches from its trunk at most
+	static constexpr int32 MaxStructureReach = 4;
 	
-	bool AttemptPlaceFoliageAt(
-		TArray<FChunkColumn>& ChunkColumnsData,
+	// Stateless, so generation snapshots call it from worker threads without touching a UObject.
+	// Only the parts of structures inside the writer's chunk are written.
+	// Trees and cacti come from Stamps when it has the shape, and are generated in place otherwise.
+	static bool AttemptPlaceFoliageAt(
+		FStructureWriter& Writer,
+		int LocalX, int LocalY,
+		const FCompiledBiome* BiomeInfo,
+		const FRandomStream& ColumnSpecificStream,
+		const FFoliageStampLibrary* Stamps = nullptr
+	);
+
+	// Rolls the biome's trees and cacti for one column and places the first that fits, without grass.
+	// Site describes the column, so it can lie outside the writer's chunk; the rolls are the same either way.
+	static bool RollFoliageRulesAt(
+		FStructureWriter& Writer,
 		int LocalX, int LocalY,
-		const FBiomeSettings* BiomeInfo,
+		const FStructureSite& Site,
+		const FCompiledBiome* BiomeInfo,
 		const FRandomStream& ColumnSpecificStream,
-		int ChunkSize, int ChunkHeight
+		const FFoliageStampLibrary* Stamps = nullptr
+	);
+
+	// Places one structure of Rule on the site's surface, sized and shaped by FoliageInstanceStream.
+	// Fails when the spot is taken or the structure can't fit under the world's ceiling.
+	static bool PlaceFoliageRuleAt(
+		FStructureWriter& Writer,
+		int LocalX, int LocalY,
+		const FStructureSite& Site,
+		const FCompiledFoliageRule& Rule,
+		FRandomStream& FoliageInstanceStream,
+		const FFoliageStampLibrary* Stamps = nullptr
+	);
+
+	// Rolls the biome's surface grass for one column
+	static bool AttemptPlaceGrassAt(
+		FStructureWriter& Writer,
+		int LocalX, int LocalY,
+		const FCompiledBiome* BiomeInfo,
+		const FRandomStream& ColumnSpecificStream
 	);
 
+	// Generates one structure into an empty box and stores it as a stamp, in the same style as in-place generation
+	static void BakeStamp(EFoliageType Type, int Height, bool bLargeVariant, FRandomStream& Stream, FFoliageStamp& OutStamp);
+
 private:
-	void GenerateOakTree(TArray<FChunkColumn>& ChunkColumnsData, const FIntVector& TreeBaseLocalPosInChunk,
-		int Height, bool bLargeVariant, FRandomStream& TreeInstanceStream,
-		int ChunkSize, int ChunkHeight);
-	void GenerateBirchTree(TArray<FChunkColumn>& ChunkColumnsData, const FIntVector& TreeBaseLocalPosInChunk,
-		int Height, bool bLargeVariant, FRandomStream& TreeInstanceStream,
-		int ChunkSize, int ChunkHeight);
-	void GenerateCactus(TArray<FChunkColumn>& ChunkColumnsData, const FIntVector& CactusBaseLocalPosInChunk,
-		int Height, FRandomStream& TreeInstanceStream,
-		int ChunkSize, int ChunkHeight);
-	void GenerateGrass(TArray<EBlock>& Blocks, int BaseZ, int ChunkHeight);
+	static void GenerateOakTree(FStructureWriter& Writer, const FIntVector& TreeBaseLocalPosInChunk,
+		int Height, bool bLargeVariant, FRandomStream& TreeInstanceStream);
+	static void GenerateBirchTree(FStructureWriter& Writer, const FIntVector& TreeBaseLocalPosInChunk,
+		int Height, bool bLargeVariant, FRandomStream& TreeInstanceStream);
+	static void GenerateCactus(FStructureWriter& Writer, const FIntVector& CactusBaseLocalPosInChunk,
+		int Height, FRandomStream& TreeInstanceStream);
+	static void GenerateGrass(TArrayView<EBlock> Blocks, int BaseZ, int ChunkHeight);
 	
-	void SetBlockInSingleColumnArray(TArray<EBlock>& Blocks, int Z, EBlock BlockType, int ChunkHeight) const;
-	void SetBlockInChunkColumns(
-		TArray<FChunkColumn>& ChunkColumnsData,
-		int LocalX, int LocalY, int LocalZ,
-		EBlock BlockType,
-		int ChunkSize, int ChunkHeight) const;
+	static void SetBlockInSingleColumnArray(TArrayView<EBlock> Blocks, int Z, EBlock BlockType, int ChunkHeight);
 	
 };
@@ -2,7 +2,7 @@
 
 #include "CoreMinimal.h"
 #include "Components/ActorComponent.h"
-#include "Structs/BiomeSettings.h"
+#include "Objects/TerrainGeneratorState.h"
 #include "Structs/NoiseOctaveSettingsAsset.h"
 #include "Structs/TerrainData.h" // Keep for Threshold structs
 #include "VoxelGen/Enums.h"
@@ -11,9 +11,8 @@
 class UNoiseGenerationPreset;
 // Forward Declarations
 class AChunkWorld;
-class UFoliageGenerator;
 struct FChunkColumn;
-class UFastNoiseWrapper;
+struct FChunkVoxels;
 class UCurveFloat; // Ensure UCurveFloat is known
 
 UCLASS(Blueprintable, ClassGroup = (Custom), meta = (BlueprintSpawnableComponent))
@@ -21,25 +20,42 @@ class VOXELGEN_API UTerrainGenerator : public UActorComponent
 {
     GENERATED_BODY()
 
+    // Cross-checks the compiled classifier against the decision tree it was built from
+    friend class FBiomeClassifierMatchesDecisionTreeTest;
+
 public:
     UTerrainGenerator();
 
-    // THIS is now the main function. Calculates all data for a single column on demand.
-    FChunkColumn GenerateColumnData(int GlobalX, int GlobalY);
+    // Current generation snapshot; hand it to worker tasks so they never touch this component
+    FTerrainGeneratorStatePtr GetState() const { return State; }
+
+    // Height, biome and climate at one world column. Thread-safe; allocation-free once the column's tile is cached.
+    FTerrainSurfaceSample QuerySurface(int32 GlobalX, int32 GlobalY) const;
 
-    // Populates blocks based on biome and height (logic remains similar)
-    void PopulateColumnBlocks(FChunkColumn& ColumnData) const;
+    // Surface samples for every column in Rect (Max exclusive), row-major. OutSamples is reused when large enough.
+    void QuerySurfaceRegion(const FIntRect& Rect, TArray<FTerrainSurfaceSample>& OutSamples) const;
 
-    // Foliage placement logic remains similar
-    void DecorateChunkWithFoliage(
-        TArray<FChunkColumn>& InOutChunkColumns,
-        const FIntVector2& ChunkGridPosition,
-        const FRandomStream& WorldFoliageStreamBase
-    ) const;
+    // Column with its surface data filled in, built on QuerySurface
+    FChunkColumn GenerateColumnData(int GlobalX, int GlobalY) const;
+
+    // Generates, populates and decorates one chunk's voxels from the current snapshot
+    void GenerateChunk(const FIntVector2& ChunkGridPosition, FChunkVoxels& OutVoxels) const;
 
     bool IsNoiseInitialized() const { return bNoiseInitialized; }
 
-	void UpdateSeed(int32 NewSeed) const;
+    // Initializes without an owning AChunkWorld or game instance, for commandlets and tools
+    void InitializeStandalone(int32 InSeed, int32 InChunkSize, int32 InChunkHeight);
+
+    // Builds a fresh snapshot with an empty field cache; in-flight tasks keep the old one
+    void RebuildState();
+
+    const FTerrainGenerationStats& GetGenerationStats() const { return *GenerationStats; }
+    void ResetGenerationStats() const { GenerationStats->Reset(); }
+
+    int32 GetChunkSize() const { return CachedChunkSize; }
+    int32 GetChunkHeight() const { return CachedChunkHeight; }
+
+	void UpdateSeed(int32 NewSeed);
     UFUNCTION(BlueprintCallable)
 	void SetNoisePreset(UNoiseGenerationPreset* NewPreset);
 
@@ -49,14 +65,22 @@ public:
 protected:
     virtual void BeginPlay() override;
 
+#if WITH_EDITOR
+    virtual void PostEditChangeProperty(FPropertyChangedEvent& PropertyChangedEvent) override;
+#endif
+
 private:
     // Initializes noise generators ONCE
     void InitializeNoise();
-    void SetupNoise(TObjectPtr<UFastNoiseWrapper>& Noise, const UNoiseOctaveSettingsAsset* Settings);
+    // Bakes LUTs, classifier and biome table, then builds the first snapshot
+    void InitializeGeneration();
+
+    // Noise source for one field, logging the interpolation error when it is coarse-sampled
+    void SetupNoiseSource(FTerrainNoiseSource& Source, const UNoiseOctaveSettingsAsset* Settings, bool bAllowCoarse, const TCHAR* FieldName) const;
 
-    // Calculates terrain parameters (Cont, Ero, Weird, PV) for a specific point
-    FTerrainParameterData CalculateTerrainParameters(int GlobalX, int GlobalY) const;
-    void ApplySpline(const UCurveFloat* Spline, float InValue, float& OutValue) const; // Make const
+    // Bakes the spline curves into lookup tables and logs each table's max error against its curve
+    void BakeSplineLUTs();
+    void BakeSplineLUT(FSplineLUT& LUT, const UCurveFloat* Spline, const TCHAR* SplineName) const;
 
     // Determines biome type based on calculated inputs for a specific point
     EBiomeType DetermineBiomeType(const FCategorizedBiomeInputs& Params) const;
@@ -74,17 +98,28 @@ private:
     EBiomeType MapBeachBiome(ETemperatureType Temp) const;
     EBiomeType MapShatteredBiome(ETemperatureType Temp, EHumidityType Hum, float Weirdness) const;
 
-    // Helper to get biome settings from table (make const)
-    FBiomeSettings* GetBiomeSettings(EBiomeType BiomeType) const;
+    // Compiles BiomesTable into the dense per-EBiomeType table read during generation
+    void CompileBiomeTable();
+    void OnBiomesTableChanged();
 
-    // Helper for remapping (make const)
-    float Remap01toNeg11(float Value01) const { return Value01 * 2.0f - 1.0f; }
+    // Compiles the categorize/determine decision tree into BiomeClassifier's lookup table
+    void BuildBiomeClassifier();
 
+    // Surface sample used before initialization
+    FTerrainSurfaceSample GetFallbackSurface() const;
 
 public:
 	UPROPERTY(EditAnywhere, Category = "Settings|Biomes")
 	TObjectPtr<UDataTable> BiomesTable;
 
+	// Columns over which biome heights and surface layers blend across a border; 0 keeps hard edges
+	UPROPERTY(EditAnywhere, Category = "Settings|Biomes", meta = (ClampMin = "0", ClampMax = "32", UIMin = "0", UIMax = "32"))
+	int32 BiomeBlendRadius = 8;
+
+	// Spacing of the biome grid the blend reads; raised when needed to keep a column at 81 kernel taps or fewer
+	UPROPERTY(EditAnywhere, Category = "Settings|Biomes", meta = (ClampMin = "1", ClampMax = "16", UIMin = "1", UIMax = "16"))
+	int32 BiomeBlendGridStep = 4;
+
 	UPROPERTY(EditAnywhere, Category = "Settings|Noise")
 	TObjectPtr<UNoiseGenerationPreset> NoiseGenerationPreset;
 
@@ -97,6 +132,46 @@ public:
 	UPROPERTY(EditAnywhere, Category = "Settings|Terrain Generation")
 	float TerrainAmplitude = 50.0f;
 
+	// Samples low-frequency fields on a coarse lattice (per-asset CoarseSampleStep) and interpolates the rest
+	UPROPERTY(EditAnywhere, Category = "Settings|Noise")
+	bool bCoarseNoiseSampling = false;
+
+	// Number of 64x64 column tiles kept in the shared field cache
+	UPROPERTY(EditAnywhere, Category = "Settings|Terrain Generation", meta = (ClampMin = "1", UIMin = "1"))
+	int32 FieldCacheMaxTiles = 64;
+
+	// Reshapes the heightmap with the preset's 3D Density and Caves noise: overhangs around the surface, caves in CaveLayers
+	UPROPERTY(EditAnywhere, Category = "Settings|Density")
+	bool bDensityTerrain = false;
+
+	// Half-height of the band around the 2D surface where density noise can add or remove blocks
+	UPROPERTY(EditAnywhere, Category = "Settings|Density", meta = (ClampMin = "1", UIMin = "1", EditCondition = "bDensityTerrain"))
+	int32 SurfaceBandDepth = 8;
+
+	// Density lattice spacing in columns and in blocks of height (rounded up to a multiple of 4); values in between are trilinear
+	UPROPERTY(EditAnywhere, Category = "Settings|Density", meta = (ClampMin = "1", ClampMax = "16", EditCondition = "bDensityTerrain"))
+	int32 DensityLatticeStepXY = 4;
+	UPROPERTY(EditAnywhere, Category = "Settings|Density", meta = (ClampMin = "4", ClampMax = "32", EditCondition = "bDensityTerrain"))
+	int32 DensityLatticeStepZ = 8;
+
+	UPROPERTY(EditAnywhere, Category = "Settings|Density", meta = (EditCondition = "bDensityTerrain"))
+	TArray<FCaveLayer> CaveLayers;
+
+	// Per-column rolls, or one jittered candidate per grid cell. A cell fires a rule with the chance any of its
+	// columns would, 1 - (1 - p)^area, which saturates towards 1 for common rules on large cells. Where a surface's
+	// rules add up past 1 they are scaled down together, so denser settings stop adding trees there rather than
+	// crowding out later rules.
+	UPROPERTY(EditAnywhere, Category = "Settings|Foliage")
+	EFoliagePlacement FoliagePlacement = EFoliagePlacement::PerColumn;
+
+	// Grid cell width in columns; each cell holds at most one tree or cactus
+	UPROPERTY(EditAnywhere, Category = "Settings|Foliage", meta = (ClampMin = "2", ClampMax = "32", EditCondition = "FoliagePlacement == EFoliagePlacement::JitteredGrid"))
+	int32 FoliageGridCellSize = 5;
+
+	// Smallest distance along each axis between candidates of neighbouring cells; limits the jitter to CellSize - MinSpacing
+	UPROPERTY(EditAnywhere, Category = "Settings|Foliage", meta = (ClampMin = "0", ClampMax = "31", EditCondition = "FoliagePlacement == EFoliagePlacement::JitteredGrid"))
+	int32 FoliageMinSpacing = 2;
+
 	UPROPERTY(EditAnywhere, Category = "Settings|Splines")
 	TObjectPtr<UCurveFloat> ContinentalnessSpline;
 	UPROPERTY(EditAnywhere, Category = "Settings|Splines")
@@ -106,6 +181,10 @@ public:
 	UPROPERTY(EditAnywhere, Category = "Settings|Splines")
 	TObjectPtr<UCurveFloat> PeaksValleysSpline;
 
+	// Number of samples each spline is baked into; higher is closer to the curve but uses more cache
+	UPROPERTY(EditAnywhere, Category = "Settings|Splines", meta = (ClampMin = "2", UIMin = "2"))
+	int32 SplineLUTResolution = 1024;
+
 	UPROPERTY(EditAnywhere, Category = "Settings|Splines")
 	float ContinentalnessWeight = 0.5f;
 	UPROPERTY(EditAnywhere, Category = "Settings|Splines")
@@ -125,18 +204,29 @@ public:
 	FPeaksValleysData PeaksValleysThresholds;
 
 private:
-    UPROPERTY()
-	TObjectPtr<UFoliageGenerator> FoliageGenerator;
-
 	UPROPERTY()
 	TObjectPtr<AChunkWorld> ParentWorld;
 
-	UPROPERTY() TObjectPtr<UFastNoiseWrapper> ContinentalnessNoise;
-	UPROPERTY() TObjectPtr<UFastNoiseWrapper> ErosionNoise;
-	UPROPERTY() TObjectPtr<UFastNoiseWrapper> WeirdnessNoise;
-	UPROPERTY() TObjectPtr<UFastNoiseWrapper> TemperatureNoise;
-	UPROPERTY() TObjectPtr<UFastNoiseWrapper> HumidityNoise;
+	// Compiled once per settings change and copied into every snapshot
+	FSplineLUT ContinentalnessLUT;
+	FSplineLUT ErosionLUT;
+	FSplineLUT WeirdnessLUT;
+	FSplineLUT PeaksValleysLUT;
+
+	TSharedPtr<const FCompiledBiomeTable, ESPMode::ThreadSafe> CompiledBiomes;
+
+	FBiomeClassifier BiomeClassifier;
+	TWeakObjectPtr<UDataTable> CompiledBiomesSource;
+
+	// Published on the game thread only; readers copy the pointer and keep the snapshot alive
+	FTerrainGeneratorStatePtr State;
+	TSharedPtr<FTerrainGenerationStats, ESPMode::ThreadSafe> GenerationStats;
 
 	// Internal State
 	bool bNoiseInitialized = false;
-};
\ No newline at end of file
+
+	// World layout captured at initialization
+	int32 CachedSeed = 0;
+	int32 CachedChunkSize = 0;
+	int32 CachedChunkHeight = 0;
+};
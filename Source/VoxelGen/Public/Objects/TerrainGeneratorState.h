@@ -0,0 +1,156 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "Structs/BiomeBlend.h"
+#include "Structs/BiomeClassifier.h"
+#include "Structs/BiomeSettings.h"
+#include "Structs/ChunkVoxels.h"
+#include "Structs/ColumnSpans.h"
+#include "Structs/DensityLattice.h"
+#include "Structs/FoliageStamps.h"
+#include "Structs/SplineLUT.h"
+#include "Structs/StructurePlacement.h"
+#include "Structs/TerrainData.h"
+#include "Structs/TerrainFieldCache.h"
+#include "Structs/TerrainGenerationStats.h"
+#include "Structs/TerrainNoiseSource.h"
+
+struct FChunkColumn;
+
+// Immutable snapshot of everything terrain generation reads: noise, spline LUTs, thresholds and the biome table.
+// Built by UTerrainGenerator from its settings on the game thread, then shared by refcount with worker tasks.
+// A seed or settings change builds a new snapshot; tasks keep generating from the one they started with.
+class VOXELGEN_API FTerrainGeneratorState
+{
+public:
+	// Generates, populates and decorates one chunk's voxels. Structures rooted in neighbouring chunks that reach into
+	// this one are placed too, so the result only depends on the seed and the chunk's position.
+	void GenerateChunk(const FIntVector2& ChunkGridPosition, FChunkVoxels& OutVoxels) const;
+
+	// Calculates column data for a whole chunk from one blended surface region query
+	void GenerateChunkColumns(const FIntVector2& ChunkGridPosition, TArray<FChunkColumn>& OutColumns) const;
+
+	// Blends biome height offsets across borders and dithers each column's surface biome by its biome weights.
+	// InOutSamples holds Rect row-major. Weights come from an FBiomeBlendGrid over the cached field tiles.
+	void BlendBiomeBorders(const FIntRect& Rect, TArrayView<FTerrainSurfaceSample> InOutSamples) const;
+
+	// Runs the noise, spline, height and biome stages over the region described by Fields
+	void GenerateTerrainFields(FTerrainFieldBuffer& Fields) const;
+
+	// Surface queries report the blended height and biome, matching the generated columns
+	FTerrainSurfaceSample QuerySurface(int32 GlobalX, int32 GlobalY) const;
+	void QuerySurfaceRegion(const FIntRect& Rect, TArray<FTerrainSurfaceSample>& OutSamples) const;
+	FChunkColumn GenerateColumnData(int32 GlobalX, int32 GlobalY) const;
+
+	// Populates one column's blocks based on biome and height
+	void PopulateColumnBlocks(const FChunkColumn& ColumnData, TArrayView<EBlock> OutBlocks) const;
+
+	// Column contents as typed spans (stone, surface layers, water) for a column with its surface data set
+	void BuildColumnSpans(const FChunkColumn& ColumnData, FColumnSpans& OutSpans) const;
+
+	// Reshapes populated columns with 3D density noise: overhangs within the surface band, then the cave layers.
+	// Only the band around each column's 2D height and the configured cave ranges are evaluated; everything else
+	// keeps its heightmap blocks. Column heights are moved to the new top solid block, surface queries keep the 2D height.
+	void DensityStage(const FIntVector2& ChunkGridPosition, FChunkVoxels& InOutVoxels) const;
+
+	bool HasDensityStage() const { return bDensityTerrain && (DensityNoise.IsValid() || (CaveNoise.IsValid() && !CaveLayers.IsEmpty())); }
+
+	// Sites of the columns in Rect, row-major, as generating their chunks would leave them before decoration:
+	// only the surface and the density band are built, which is all that decides a structure
+	void ProbeStructureSites(const FIntRect& Rect, TArray<FStructureSite>& OutSites) const;
+
+	void DecorateChunkWithFoliage(FChunkVoxels& InOutVoxels, const FIntVector2& ChunkGridPosition,
+		const FRandomStream& WorldFoliageStreamBase) const;
+
+	// Jittered-grid placement: candidate columns come from a hash of the seed and world grid cell, so a chunk's trees
+	// never depend on which neighbours were generated first. Grass is still rolled per column.
+	void DecorateChunkOnFoliageGrid(FChunkVoxels& InOutVoxels, const FIntVector2& ChunkGridPosition,
+		const FRandomStream& WorldFoliageStreamBase) const;
+
+	int32 GetSeed() const { return Seed; }
+	int32 GetChunkSize() const { return ChunkSize; }
+	int32 GetChunkHeight() const { return ChunkHeight; }
+
+private:
+	friend class UTerrainGenerator;
+
+	FTerrainFieldCache::FTileRef GetFieldTile(const FIntVector2& TileCoordinates) const;
+
+	// Copies the unblended tile samples for Rect into OutSamples, row-major
+	void ReadSurfaceRegion(const FIntRect& Rect, TArrayView<FTerrainSurfaceSample> OutSamples) const;
+
+	// Heights [OutMinZ, OutMaxZ) around the column's 2D height that surface density can change
+	void GetSurfaceBand(const FChunkColumn& Column, int32& OutMinZ, int32& OutMaxZ) const;
+	// Samples surface density over the bands of Columns, which hold Rect
+	void SampleSurfaceLattice(const FIntRect& Rect, TConstArrayView<FChunkColumn> Columns, FDensityLattice& OutLattice) const;
+	// Reshapes one populated column's band and moves its height to the new top solid block; returns the voxels evaluated
+	int32 ResurfaceColumn(FChunkColumn& Column, EBlock* Blocks, const FDensityLattice& SurfaceLattice, float* Density) const;
+
+	// Seed of the stream per-column foliage is rolled from, one per chunk
+	int32 GetFoliageStreamSeed(const FIntVector2& ChunkGridPosition) const;
+
+	// Batched generation stages, each one a flat loop over the region
+	void SampleNoiseStage(FTerrainFieldBuffer& Fields) const;
+	void NormalizeNoiseStage(FTerrainFieldBuffer& Fields) const;
+	void SplineStage(FTerrainFieldBuffer& Fields) const;
+	void HeightStage(FTerrainFieldBuffer& Fields) const;
+	void BiomeStage(FTerrainFieldBuffer& Fields) const;
+
+	void ApplySpline(const FSplineLUT& SplineLUT, float InValue, float& OutValue) const;
+	float Remap01toNeg11(float Value01) const { return Value01 * 2.0f - 1.0f; }
+
+	// World layout
+	int32 Seed = 0;
+	int32 ChunkSize = 0;
+	int32 ChunkHeight = 0;
+
+	FTerrainNoiseSource ContinentalnessNoise;
+	FTerrainNoiseSource ErosionNoise;
+	FTerrainNoiseSource WeirdnessNoise;
+	FTerrainNoiseSource TemperatureNoise;
+	FTerrainNoiseSource HumidityNoise;
+	FTerrainNoiseSource DensityNoise;
+	FTerrainNoiseSource CaveNoise;
+
+	FSplineLUT ContinentalnessLUT;
+	FSplineLUT ErosionLUT;
+	FSplineLUT WeirdnessLUT;
+	FSplineLUT PeaksValleysLUT;
+
+	FBiomeClassifier BiomeClassifier;
+	TSharedPtr<const FCompiledBiomeTable, ESPMode::ThreadSafe> CompiledBiomes;
+	// Trees and cacti baked from this seed and biome table
+	TSharedPtr<const FFoliageStampLibrary, ESPMode::ThreadSafe> FoliageStamps;
+
+	int32 WaterThreshold = 55;
+	float AltitudeTemperatureFactor = 0.01f;
+	float TerrainBaseHeight = 60.0f;
+	float TerrainAmplitude = 50.0f;
+	float ContinentalnessWeight = 0.5f;
+	float ErosionWeight = 0.2f;
+	float PeaksValleysWeight = 0.3f;
+
+	// Biome blending, off when the radius is 0
+	int32 BiomeBlendRadius = 0;
+	int32 BiomeBlendStep = 4;
+
+	// 3D density
+	bool bDensityTerrain = false;
+	int32 SurfaceBandDepth = 8;
+	int32 DensityStepXY = 4;
+	int32 DensityStepZ = 8;
+	TArray<FCaveLayer> CaveLayers;
+
+	// Foliage placement
+	EFoliagePlacement FoliagePlacement = EFoliagePlacement::PerColumn;
+	int32 FoliageCellSize = 5;
+	int32 FoliageMinSpacing = 2;
+
+	// Fields generated from this snapshot; dies with it, so a new seed never reads stale tiles
+	mutable FTerrainFieldCache FieldCache;
+
+	// Shared with the generator so stats survive snapshot swaps
+	TSharedPtr<FTerrainGenerationStats, ESPMode::ThreadSafe> Stats;
+};
+
+using FTerrainGeneratorStatePtr = TSharedPtr<const FTerrainGeneratorState, ESPMode::ThreadSafe>;
@@ -0,0 +1,65 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VoxelGen/Enums.h"
+
+struct FBiomeWeight
+{
+	EBiomeType Biome = EBiomeType::Desert;
+	float Weight = 0.f;
+};
+
+// Biome weights of one column, heaviest first and summing to 1
+struct VOXELGEN_API FBiomeWeights
+{
+public:
+	static constexpr int32 MaxBiomes = 4;
+
+	int32 Num() const { return Count; }
+	const FBiomeWeight& operator[](int32 Index) const { return Weights[Index]; }
+
+	// Biome whose cumulative weight covers Random01; a per-column hash dithers surface layers across a border
+	EBiomeType Pick(float Random01) const;
+
+private:
+	friend struct FBiomeBlendGrid;
+
+	TStaticArray<FBiomeWeight, MaxBiomes> Weights;
+	int32 Count = 0;
+};
+
+// Biomes of one chunk's neighbourhood sampled every Step columns, read from the cached field tiles rather than from noise.
+// Per-column weights come from a tent kernel of Radius columns over those nodes.
+//
+// Per-chunk budget, for chunk size C: ((C + 2 * Radius) / Step + 1)^2 biome reads when the grid is built and
+// (2 * Radius / Step + 1)^2 taps per column. The defaults (C = 16, Radius = 8, Step = 4) come to 81 reads and
+// 6400 taps per chunk, no noise evaluations; UTerrainGenerator caps the taps per column at 81.
+struct VOXELGEN_API FBiomeBlendGrid
+{
+public:
+	// Grid nodes covering columns [OriginX - Radius, OriginX + SizeX + Radius] (and the same along Y) on world multiples
+	// of Step; Radius is at least Step
+	void Initialize(int32 OriginX, int32 OriginY, int32 SizeX, int32 SizeY, int32 InRadius, int32 InStep);
+
+	// World column of every node, row-major; fill the matching GetBiomes() entry for each
+	int32 GetNodeCountX() const { return NodeCountX; }
+	int32 GetNodeCountY() const { return NodeCountY; }
+	FIntPoint GetNodeColumn(int32 NodeX, int32 NodeY) const { return FIntPoint((NodeMinX + NodeX) * Step, (NodeMinY + NodeY) * Step); }
+	TArray<EBiomeType, TInlineAllocator<96>>& GetBiomes() { return Biomes; }
+
+	void ComputeWeights(int32 GlobalX, int32 GlobalY, FBiomeWeights& OutWeights) const;
+
+private:
+	FORCEINLINE int32 FloorToNode(int32 Global) const { return FMath::FloorToInt(static_cast<float>(Global) / Step); }
+
+	// Inline for a chunk or a single column at the default radius and step, so surface queries don't allocate
+	TArray<EBiomeType, TInlineAllocator<96>> Biomes;
+	int32 Radius = 0;
+	int32 Step = 1;
+	int32 NodeMinX = 0;
+	int32 NodeMinY = 0;
+	int32 NodeCountX = 0;
+	int32 NodeCountY = 0;
+};
@@ -0,0 +1,86 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TerrainData.h"
+#include "VoxelGen/Enums.h"
+
+// Biome decision tree compiled into a lookup table over the categorized inputs.
+// Banding uses prefix-max thresholds, which gives the same band as the if-chains even when thresholds are unsorted.
+struct VOXELGEN_API FBiomeClassifier
+{
+public:
+	static constexpr int32 NumTemperatureBands = 5;
+	static constexpr int32 NumHumidityBands = 5;
+	static constexpr int32 NumContinentalnessBands = 7;
+	static constexpr int32 NumErosionBands = 7;
+	static constexpr int32 NumPVBands = 5;
+	static constexpr int32 NumWeirdnessBands = 2;
+	static constexpr int32 TableSize = NumTemperatureBands * NumHumidityBands * NumContinentalnessBands
+		* NumErosionBands * NumPVBands * NumWeirdnessBands;
+
+	// The decision tree only ever tests weirdness against this value
+	static constexpr float WeirdnessSplit = 0.1f;
+
+	void Build(const FTemperatureData& Temperature, const FHumidityData& Humidity,
+		const FContinentalnessData& Continentalness, const FErosionData& Erosion, const FPeaksValleysData& PeaksValleys,
+		TFunctionRef<EBiomeType(const FCategorizedBiomeInputs&)> DetermineBiome);
+
+	bool IsBuilt() const { return bIsBuilt; }
+
+	// All inputs are in [-1, 1]
+	FORCEINLINE EBiomeType Classify(float Temperature, float Humidity, float Continentalness, float Erosion,
+		float PeaksValleys, float Weirdness) const
+	{
+		return Table[GetTableIndex(
+			Band(TemperatureBands, Temperature),
+			Band(HumidityBands, Humidity),
+			Band(ContinentalnessBands, Continentalness),
+			Band(ErosionBands, Erosion),
+			Band(PVBands, PeaksValleys),
+			Weirdness > WeirdnessSplit ? 1 : 0)];
+	}
+
+	FORCEINLINE ETemperatureType BandTemperature(float Value) const { return static_cast<ETemperatureType>(Band(TemperatureBands, Value)); }
+	FORCEINLINE EHumidityType BandHumidity(float Value) const { return static_cast<EHumidityType>(Band(HumidityBands, Value)); }
+	FORCEINLINE EContinentalnessType BandContinentalness(float Value) const { return static_cast<EContinentalnessType>(Band(ContinentalnessBands, Value)); }
+	FORCEINLINE EErosionType BandErosion(float Value) const { return static_cast<EErosionType>(Band(ErosionBands, Value)); }
+	FORCEINLINE EPVType BandPV(float Value) const { return static_cast<EPVType>(Band(PVBands, Value)); }
+
+private:
+	template <int32 NumBands>
+	struct FBandThresholds
+	{
+		float Values[NumBands - 1];
+
+		void Set(std::initializer_list<float> Thresholds);
+	};
+
+	// Counts the thresholds the value is not below. !(V < T) keeps NaN in the last band, like the if-chains.
+	template <int32 NumBands>
+	static FORCEINLINE int32 Band(const FBandThresholds<NumBands>& Thresholds, float Value)
+	{
+		int32 Result = 0;
+		for (int32 i = 0; i < NumBands - 1; ++i)
+		{
+			Result += !(Value < Thresholds.Values[i]);
+		}
+		return Result;
+	}
+
+	static FORCEINLINE int32 GetTableIndex(int32 Temperature, int32 Humidity, int32 Continentalness, int32 Erosion, int32 PV, int32 Weirdness)
+	{
+		return ((((Temperature * NumHumidityBands + Humidity) * NumContinentalnessBands + Continentalness)
+			* NumErosionBands + Erosion) * NumPVBands + PV) * NumWeirdnessBands + Weirdness;
+	}
+
+	FBandThresholds<NumTemperatureBands> TemperatureBands;
+	FBandThresholds<NumHumidityBands> HumidityBands;
+	FBandThresholds<NumContinentalnessBands> ContinentalnessBands;
+	FBandThresholds<NumErosionBands> ErosionBands;
+	FBandThresholds<NumPVBands> PVBands;
+
+	TStaticArray<EBiomeType, TableSize> Table;
+	bool bIsBuilt = false;
+};
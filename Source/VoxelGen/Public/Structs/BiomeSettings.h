@@ -4,8 +4,12 @@
 
 #include "CoreMinimal.h"
 #include "BlockLayer.h"
+#include "ColumnSpans.h"
+#include "Containers/StaticArray.h"
 #include "BiomeSettings.generated.h"
 
+class UDataTable;
+
 USTRUCT(BlueprintType)
 struct FFoliageSpawnRule
 {
@@ -43,6 +47,10 @@ struct VOXELGEN_API FBiomeSettings : public FTableRowBase
 	UPROPERTY(EditAnywhere, Category = "Biome Settings")
 	TArray<FBlockLayer> Layers;
 
+	// Blocks added to the terrain height inside this biome, blended across biome borders
+	UPROPERTY(EditAnywhere, Category = "Biome Settings")
+	float HeightOffset = 0.f;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Foliage")
 	TArray<FFoliageSpawnRule> FoliageRules;
 
@@ -52,3 +60,62 @@ struct VOXELGEN_API FBiomeSettings : public FTableRowBase
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Foliage")
 	TArray<EBlock> GrassSpawnableOn;
 };
+
+// One bit per EBlock, for testing a block against a set without a search
+FORCEINLINE uint32 GetBlockMask(EBlock Block) { return 1u << static_cast<uint32>(Block); }
+static_assert(BlockTypeCount <= 32, "Block masks are 32 bits wide");
+
+// Foliage rule flattened for generation: allowed surfaces as a block mask, chances as thresholds for FRand
+struct FCompiledFoliageRule
+{
+	EFoliageType Type = EFoliageType::OakTree;
+	uint32 SurfaceMask = 0;
+	float SpawnThreshold = 0.f;
+	float VariantThreshold = 0.f;
+	int32 MinHeight = 0;
+	int32 MaxHeight = 0;
+};
+
+// Biome row compiled for generation. Layers are merged into spans so populating a column is a few bulk fills.
+struct VOXELGEN_API FCompiledBiome
+{
+	bool bIsValid = false;
+
+	// Surface layers top-down, Start/End measured in blocks below the column's surface; stone continues below them
+	TArray<FColumnSpan> SurfaceLayers;
+	int32 SurfaceDepth = 0;
+	float HeightOffset = 0.f;
+
+	// Block Depth blocks below an air block, stone past the surface layers
+	EBlock GetSurfaceBlock(int32 Depth) const
+	{
+		for (const FColumnSpan& Layer : SurfaceLayers)
+		{
+			if (Depth < Layer.End) return Layer.Block;
+		}
+		return EBlock::Stone;
+	}
+
+	TArray<FCompiledFoliageRule> FoliageRules;
+	uint32 GrassSurfaceMask = 0;
+	float GrassThreshold = 0.f;
+
+	// Every surface any foliage rule or grass can grow on; columns on anything else skip foliage before touching the RNG
+	uint32 FoliageSurfaceMask = 0;
+};
+
+// Dense, immutable table of compiled biomes indexed by EBiomeType, built once from the biomes DataTable
+struct VOXELGEN_API FCompiledBiomeTable
+{
+public:
+	void Compile(const UDataTable* BiomesTable);
+
+	const FCompiledBiome* Find(EBiomeType BiomeType) const
+	{
+		const FCompiledBiome& Biome = Biomes[static_cast<int32>(BiomeType)];
+		return Biome.bIsValid ? &Biome : nullptr;
+	}
+
+private:
+	TStaticArray<FCompiledBiome, BiomeTypeCount> Biomes;
+};
@@ -6,6 +6,8 @@
 #include "VoxelGen/Enums.h"
 #include "BlockSettings.generated.h"
 
+class UStaticMesh;
+
 USTRUCT(BlueprintType)
 struct VOXELGEN_API FBlockTextureData
 {
@@ -61,6 +63,11 @@ struct VOXELGEN_API FBlockSettings : public FTableRowBase
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Block Properties", meta = (EditCondition = "RenderMode == EBlockRenderMode::CrossPlanes"))
 	bool RandomRotation = false;
 
+	// Drawn as instances of this mesh instead of planes in the chunk mesh, so removing one doesn't remesh the chunk.
+	// Authored one unscaled block wide with its pivot at the bottom centre; the material reads the texture variant from custom data 0.
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Block Properties", meta = (EditCondition = "RenderMode == EBlockRenderMode::CrossPlanes"))
+	TObjectPtr<UStaticMesh> InstanceMesh;
+
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Block Texture")
 	int NumTextureVariants = 1;
 	
@@ -8,7 +8,7 @@
 #include "ChunkColumn.generated.h"
 
 struct FBiomeSettings;
-enum class EBlock;
+enum class EBlock : uint8;
 
 USTRUCT(BlueprintType)
 struct FChunkColumn
@@ -16,9 +16,7 @@ struct FChunkColumn
 	GENERATED_BODY()
 
 public:
-	UPROPERTY()
-	TArray<EBlock> Blocks;
-	
+	// Blocks live in the chunk's FChunkVoxels; a column only holds what describes it
 	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category = "Chunk Column Data")
 	int Height;
 	
@@ -50,10 +48,9 @@ private:
 public:
 	FChunkColumn() = default;
 
-	FChunkColumn(int ChunkHeight, int x, int y)
+	FChunkColumn(int x, int y)
 		: X(x), Y(y)
 	{
-		Blocks.SetNum(ChunkHeight);
 	}
     
 	EBiomeType GetBiomeType() const { return BiomeType; }
@@ -66,4 +63,13 @@ public:
 		Erosion = NewTerrainData.Erosion;
 		PeaksValleys = NewTerrainData.PeaksValleys;
 	}
+
+	void SetSurfaceSample(const FTerrainSurfaceSample& Sample)
+	{
+		Height = Sample.Height;
+		Temperature = Sample.Temperature;
+		Humidity = Sample.Humidity;
+		BiomeType = Sample.Biome;
+		SetGenerationData(FTerrainParameterData(Sample.Continentalness, Sample.Erosion, Sample.Weirdness, Sample.PeaksValleys));
+	}
 };
\ No newline at end of file
@@ -0,0 +1,33 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VoxelGen/Enums.h"
+
+struct FChunkVoxels;
+
+// Player edits to one chunk as block index -> block, laid over the voxels generation produces for it.
+// A chunk comes back by generating it and replaying its delta, so what is kept grows with edits, not with chunks.
+// Indices are FChunkVoxels block indices, which only hold for one chunk size and height.
+struct VOXELGEN_API FChunkEditDelta
+{
+public:
+	// Later edits to the same block replace earlier ones
+	void Record(int32 BlockIndex, EBlock Block) { Edits.Add(BlockIndex, Block); }
+
+	// Writes every edit over the voxels, packed or not
+	void Apply(FChunkVoxels& InOutVoxels) const;
+	void Reset() { Edits.Reset(); }
+
+	bool IsEmpty() const { return Edits.IsEmpty(); }
+	int32 Num() const { return Edits.Num(); }
+
+	SIZE_T GetAllocatedSize() const { return Edits.GetAllocatedSize(); }
+
+	// Sets the archive's error and leaves the delta empty on an out of range block
+	friend VOXELGEN_API FArchive& operator<<(FArchive& Ar, FChunkEditDelta& Delta);
+
+private:
+	TMap<int32, EBlock> Edits;
+};
@@ -0,0 +1,30 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+
+struct FEncodedChunkVoxels;
+
+// Totals for chunks run-length encoded into the saved-chunk cache and decoded back out.
+// Sizes count block storage only, see FEncodedChunkVoxels::GetRawBlockSize.
+struct VOXELGEN_API FChunkEncodingStats
+{
+	std::atomic<uint64> ChunksEncoded { 0 };
+	std::atomic<uint64> ChunksDecoded { 0 };
+	std::atomic<uint64> RawBytesEncoded { 0 };
+	std::atomic<uint64> EncodedBytes { 0 };
+	std::atomic<uint64> EncodeCycles { 0 };
+	std::atomic<uint64> DecodeCycles { 0 };
+
+	void Reset();
+
+	// Adds one chunk's sizes; the caller times the encode itself
+	void AddEncoded(const FEncodedChunkVoxels& Encoded);
+
+	// Raw over encoded bytes, over every chunk encoded so far
+	double GetCompressionRatio() const;
+
+	static double ToSeconds(const std::atomic<uint64>& Cycles) { return FPlatformTime::ToSeconds64(Cycles.load(std::memory_order_relaxed)); }
+};
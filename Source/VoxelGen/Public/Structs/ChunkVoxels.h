@@ -0,0 +1,128 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Structs/ChunkColumn.h"
+#include "Structs/PalettedBlocks.h"
+#include "VoxelGen/Enums.h"
+
+// What one FChunkVoxels::SectionHeight-high slice of a chunk holds, so volume passes can skip air and solid fill
+enum class EChunkSectionState : uint8
+{
+	// Air throughout
+	Empty,
+	// One block type throughout
+	Uniform,
+	// Anything else, or unknown since the blocks were last written directly
+	Mixed
+};
+
+struct FChunkSection
+{
+	EChunkSectionState State = EChunkSectionState::Mixed;
+	// The block filling an empty or uniform section
+	EBlock Block = EBlock::Air;
+
+	bool IsEmpty() const { return State == EChunkSectionState::Empty; }
+	bool IsUniform() const { return State != EChunkSectionState::Mixed; }
+};
+
+// One chunk's blocks in a single buffer of 1-byte ids, plus its column metadata (height, biome, climate) alongside.
+// Blocks are column-major: each column's heights are contiguous and columns follow FChunkData::GetColumnIndexFromLocal,
+// so a column is one slice of the buffer and a whole chunk is two allocations.
+// Pack swaps the buffer for FPalettedBlocks to hold loaded chunks in a fraction of the memory; block accessors keep
+// working on packed voxels, column views need Unpack first.
+// Each SectionHeight slice is flagged empty, uniform or mixed. Block setters keep the flags conservative; writes through
+// column views or the flat buffer mark them all mixed until UpdateSections runs again.
+struct VOXELGEN_API FChunkVoxels
+{
+public:
+	FChunkVoxels() = default;
+	FChunkVoxels(int32 InChunkSize, int32 InChunkHeight) { Initialize(InChunkSize, InChunkHeight); }
+
+	static constexpr int32 SectionHeight = 16;
+
+	// Sizes both arrays for the chunk; every block starts as air and columns start empty
+	void Initialize(int32 InChunkSize, int32 InChunkHeight);
+	void Reset();
+
+	bool IsEmpty() const { return Columns.IsEmpty(); }
+	int32 GetChunkSize() const { return ChunkSize; }
+	int32 GetChunkHeight() const { return ChunkHeight; }
+	int32 NumColumns() const { return Columns.Num(); }
+
+	FORCEINLINE bool IsInside(int32 X, int32 Y, int32 Z) const
+	{
+		return X >= 0 && X < ChunkSize && Y >= 0 && Y < ChunkSize && Z >= 0 && Z < ChunkHeight;
+	}
+
+	FORCEINLINE int32 GetBlockIndex(int32 ColumnIndex, int32 Z) const { return ColumnIndex * ChunkHeight + Z; }
+	FORCEINLINE int32 GetBlockIndex(int32 X, int32 Y, int32 Z) const { return GetBlockIndex(X + Y * ChunkSize, Z); }
+
+	// Unchecked; use IsInside for positions that may fall outside the chunk
+	FORCEINLINE EBlock GetBlock(int32 X, int32 Y, int32 Z) const { return GetBlockAt(GetBlockIndex(X, Y, Z)); }
+	FORCEINLINE void SetBlock(int32 X, int32 Y, int32 Z, EBlock Block) { SetBlockAt(GetBlockIndex(X, Y, Z), Block); }
+	FORCEINLINE EBlock GetColumnBlock(int32 ColumnIndex, int32 Z) const { return GetBlockAt(GetBlockIndex(ColumnIndex, Z)); }
+
+	FORCEINLINE EBlock GetBlockAt(int32 BlockIndex) const { return bPacked ? PackedBlocks.Get(BlockIndex) : Blocks[BlockIndex]; }
+	FORCEINLINE void SetBlockAt(int32 BlockIndex, EBlock Block)
+	{
+		if (bPacked) PackedBlocks.Set(BlockIndex, Block);
+		else Blocks[BlockIndex] = Block;
+
+		if (bSectionsValid)
+		{
+			FChunkSection& Section = Sections[BlockIndex % ChunkHeight / SectionHeight];
+			if (Section.Block != Block) Section.State = EChunkSectionState::Mixed;
+		}
+	}
+
+	// One column's blocks, bottom to top; unpacked voxels only
+	FORCEINLINE TArrayView<EBlock> GetColumnBlocks(int32 ColumnIndex)
+	{
+		checkSlow(!bPacked);
+		bSectionsValid = false;
+		return TArrayView<EBlock>(Blocks.GetData() + ColumnIndex * ChunkHeight, ChunkHeight);
+	}
+	FORCEINLINE TArrayView<const EBlock> GetColumnBlocks(int32 ColumnIndex) const
+	{
+		checkSlow(!bPacked);
+		return TArrayView<const EBlock>(Blocks.GetData() + ColumnIndex * ChunkHeight, ChunkHeight);
+	}
+
+	int32 NumSections() const { return Sections.Num(); }
+	static int32 GetSectionIndex(int32 Z) { return Z / SectionHeight; }
+	// Mixed for every section while the flags are out of date
+	FORCEINLINE FChunkSection GetSection(int32 SectionIndex) const { return bSectionsValid ? Sections[SectionIndex] : FChunkSection(); }
+
+	// Rescans the blocks and flags every section; generation and decoding call it once they are done writing
+	void UpdateSections();
+	// For writers going straight to the flat buffer
+	void InvalidateSections() { bSectionsValid = false; }
+
+	// Moves the blocks into a palette sized for the types present, freeing the flat buffer
+	void Pack();
+	void Unpack();
+	bool IsPacked() const { return bPacked; }
+	const FPalettedBlocks& GetPackedBlocks() const { return PackedBlocks; }
+
+	SIZE_T GetAllocatedSize() const
+	{
+		return Columns.GetAllocatedSize() + Blocks.GetAllocatedSize() + PackedBlocks.GetAllocatedSize() + Sections.GetAllocatedSize();
+	}
+
+	TArray<FChunkColumn> Columns;
+	// Empty while packed
+	TArray<EBlock> Blocks;
+
+private:
+	int32 ChunkSize = 0;
+	int32 ChunkHeight = 0;
+
+	FPalettedBlocks PackedBlocks;
+	bool bPacked = false;
+
+	TArray<FChunkSection> Sections;
+	bool bSectionsValid = false;
+};
@@ -0,0 +1,36 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VoxelGen/Enums.h"
+
+// Half-open run [Start, End) of one block type
+struct FColumnSpan
+{
+	EBlock Block = EBlock::Air;
+	int32 Start = 0;
+	int32 End = 0;
+
+	FColumnSpan() = default;
+	FColumnSpan(EBlock InBlock, int32 InStart, int32 InEnd) : Block(InBlock), Start(InStart), End(InEnd) {}
+
+	int32 Num() const { return End - Start; }
+};
+
+// Column contents as a short bottom-up list of typed spans; anything not covered is air.
+// Generated columns are a handful of spans (stone, surface layers, water), filled into the chunk in one pass.
+struct VOXELGEN_API FColumnSpans
+{
+public:
+	void Reset() { Spans.Reset(); }
+
+	// Appends a span above the previous one. Empty spans are dropped and touching spans of the same block merge.
+	void Add(EBlock Block, int32 Start, int32 End);
+
+	// Writes every span, and air in the gaps and above the last one, over the whole column
+	void Fill(TArrayView<EBlock> OutBlocks) const;
+
+private:
+	TArray<FColumnSpan, TInlineAllocator<6>> Spans;
+};
@@ -0,0 +1,39 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+struct FTerrainNoiseSource;
+
+// 3D noise sampled on a coarse world-aligned lattice over a box of columns and heights, read back with trilinear interpolation.
+// Nodes sit on world multiples of the steps, so neighbouring chunks interpolate from the same samples and stay seamless.
+struct VOXELGEN_API FDensityLattice
+{
+public:
+	// Samples nodes covering columns [OriginX, OriginX + SizeX) x [OriginY, OriginY + SizeY) and heights [MinZ, MaxZ).
+	// StepZ is rounded up to a multiple of 4 so interpolation can run four heights at a time.
+	void Sample(const FTerrainNoiseSource& Noise, int32 InStepXY, int32 InStepZ,
+		int32 OriginX, int32 OriginY, int32 SizeX, int32 SizeY, int32 MinZ, int32 MaxZ);
+
+	// Writes the interpolated noise for heights [MinZ, MaxZ) of one column to OutValues, which must hold MaxZ - MinZ + 3 floats
+	void InterpolateColumn(int32 GlobalX, int32 GlobalY, int32 MinZ, int32 MaxZ, float* OutValues) const;
+
+	bool IsEmpty() const { return Nodes.IsEmpty(); }
+	int32 NumNodes() const { return LatticeSizeX * LatticeSizeY * LatticeSizeZ; }
+
+private:
+	FORCEINLINE static int32 FloorToLattice(int32 Global, int32 Step) { return FMath::FloorToInt(static_cast<float>(Global) / Step); }
+
+	// Z-major per column, [ly][lx][lz], so the bilinear pass reads four contiguous node columns
+	TArray<float> Nodes;
+
+	int32 StepXY = 1;
+	int32 StepZ = 4;
+	int32 LatticeMinX = 0;
+	int32 LatticeMinY = 0;
+	int32 LatticeMinZ = 0;
+	int32 LatticeSizeX = 0;
+	int32 LatticeSizeY = 0;
+	int32 LatticeSizeZ = 0;
+};
@@ -0,0 +1,48 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Structs/ChunkColumn.h"
+#include "VoxelGen/Enums.h"
+
+struct FChunkVoxels;
+
+// Run of one block type over consecutive entries of the column-major block buffer
+struct FBlockRun
+{
+	EBlock Block = EBlock::Air;
+	uint16 Length = 0;
+
+	FBlockRun() = default;
+	FBlockRun(EBlock InBlock, uint16 InLength) : Block(InBlock), Length(InLength) {}
+};
+
+// A chunk's blocks run-length encoded for the saved-chunk cache, with its column metadata kept as is.
+// Columns are long stretches of stone, dirt and air, so a generated chunk is usually a few runs per column.
+// Runs follow the flat buffer and may cross column boundaries; there is no random access, only a full Decode.
+struct VOXELGEN_API FEncodedChunkVoxels
+{
+public:
+	// Encodes packed or unpacked voxels
+	void Encode(const FChunkVoxels& Voxels);
+	// Rebuilds unpacked voxels, columns included
+	void Decode(FChunkVoxels& OutVoxels) const;
+	void Reset();
+
+	bool IsEmpty() const { return Columns.IsEmpty(); }
+	int32 NumRuns() const { return Runs.Num(); }
+
+	// Bytes the blocks take as a flat 8-bit buffer and as runs; column metadata is the same in both and left out
+	SIZE_T GetRawBlockSize() const { return static_cast<SIZE_T>(Columns.Num()) * ChunkHeight * sizeof(EBlock); }
+	SIZE_T GetEncodedBlockSize() const { return Runs.GetAllocatedSize(); }
+
+	SIZE_T GetAllocatedSize() const { return Columns.GetAllocatedSize() + Runs.GetAllocatedSize(); }
+
+private:
+	TArray<FChunkColumn> Columns;
+	TArray<FBlockRun> Runs;
+
+	int32 ChunkSize = 0;
+	int32 ChunkHeight = 0;
+};
@@ -0,0 +1,54 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VoxelGen/Enums.h"
+
+struct FCompiledBiomeTable;
+struct FStructureWriter;
+
+// Vertical run of one block in a stamp, relative to the structure's base block
+struct FStampSpan
+{
+	int32 X = 0;
+	int32 Y = 0;
+	int32 Z = 0;
+	int32 Length = 0;
+	EBlock Block = EBlock::Air;
+};
+
+// One prebaked structure stored as vertical spans, so placing it is a handful of clipped column fills
+struct VOXELGEN_API FFoliageStamp
+{
+public:
+	TArray<FStampSpan> Spans;
+	// Highest block above the base plus one
+	int32 Height = 0;
+
+	void Place(FStructureWriter& Writer, const FIntVector& BaseLocalPosition) const;
+};
+
+// Prebaked stamps for every structure the biome table can place: each foliage type, height its rules allow and
+// size variant gets VariantsPerShape shapes. Built once per seed with the snapshot; placement picks one by hash.
+struct VOXELGEN_API FFoliageStampLibrary
+{
+public:
+	static constexpr int32 VariantsPerShape = 8;
+
+	void Build(int32 Seed, const FCompiledBiomeTable& Biomes);
+
+	// Null for shapes no biome rule asks for
+	const FFoliageStamp* Find(EFoliageType Type, int32 Height, bool bLargeVariant, uint32 Hash) const;
+
+	int32 NumStamps() const { return Shapes.Num() * VariantsPerShape; }
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	static uint32 GetShapeKey(EFoliageType Type, int32 Height, bool bLargeVariant)
+	{
+		return static_cast<uint32>(Type) << 24 | static_cast<uint32>(Height & 0x7FFFFF) << 1 | (bLargeVariant ? 1u : 0u);
+	}
+
+	TMap<uint32, TArray<FFoliageStamp>> Shapes;
+};
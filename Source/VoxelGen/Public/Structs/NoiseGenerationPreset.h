@@ -24,5 +24,12 @@ public:
 	UNoiseOctaveSettingsAsset* Temperature;
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Noise")
 	UNoiseOctaveSettingsAsset* Humidity;
+
+	// 3D noise for overhangs around the surface, used when density terrain is enabled
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Noise|Density")
+	UNoiseOctaveSettingsAsset* Density;
+	// 3D noise carving the cave layers
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Noise|Density")
+	UNoiseOctaveSettingsAsset* Caves;
 	
 };
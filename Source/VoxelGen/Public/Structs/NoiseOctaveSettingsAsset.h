@@ -32,5 +32,10 @@ public:
 	EFastNoise_Interp Interpolation = EFastNoise_Interp::Quintic;
 	UPROPERTY(EditAnywhere)
 	EFastNoise_FractalType FractalType = EFastNoise_FractalType::FBM;
+
+	// Samples this field every N columns and bilinearly interpolates in between when coarse sampling is enabled.
+	// 1 samples every column; 4 or 8 suit low-frequency fields. Ignored for weirdness, which always stays full resolution.
+	UPROPERTY(EditAnywhere, meta = (ClampMin = "1", ClampMax = "16", UIMin = "1", UIMax = "16"))
+	int32 CoarseSampleStep = 1;
 	
 };
@@ -0,0 +1,59 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VoxelGen/Enums.h"
+
+// Blocks stored as indices into a small palette, bit-packed at 1, 2, 4 or 8 bits each.
+// Indices never straddle a word, so reads are one shift and mask. Writing a block the palette doesn't hold adds it,
+// and repacks at the next width once the palette outgrows the current one. Entries are never dropped until Build.
+struct VOXELGEN_API FPalettedBlocks
+{
+public:
+	// Packs Blocks with a palette of exactly the types present, at the narrowest width that fits them
+	void Build(TArrayView<const EBlock> Blocks);
+	void Reset();
+
+	// Writes every block back out; OutBlocks must hold Num() blocks
+	void Unpack(TArrayView<EBlock> OutBlocks) const;
+
+	FORCEINLINE EBlock Get(int32 Index) const
+	{
+		const uint32 Word = Words[Index >> EntriesPerWordShift];
+		const uint32 Shift = (Index & EntriesPerWordMask) * BitsPerBlock;
+		return Palette[(Word >> Shift) & IndexMask];
+	}
+
+	void Set(int32 Index, EBlock Block);
+
+	int32 Num() const { return NumBlocks; }
+	bool IsEmpty() const { return NumBlocks == 0; }
+	int32 GetBitsPerBlock() const { return BitsPerBlock; }
+	const TArray<EBlock, TInlineAllocator<16>>& GetPalette() const { return Palette; }
+
+	SIZE_T GetAllocatedSize() const { return Words.GetAllocatedSize() + Palette.GetAllocatedSize(); }
+
+private:
+	void SetWidth(int32 InBitsPerBlock);
+	// Re-encodes every index at a wider width, keeping the palette
+	void Repack(int32 NewBitsPerBlock);
+	int32 FindOrAddPaletteIndex(EBlock Block);
+
+	FORCEINLINE void SetIndex(TArray<uint32>& InWords, int32 Index, uint32 PaletteIndex) const
+	{
+		uint32& Word = InWords[Index >> EntriesPerWordShift];
+		const uint32 Shift = (Index & EntriesPerWordMask) * BitsPerBlock;
+		Word = (Word & ~(IndexMask << Shift)) | (PaletteIndex << Shift);
+	}
+
+	TArray<EBlock, TInlineAllocator<16>> Palette;
+	TArray<uint32> Words;
+	int32 NumBlocks = 0;
+
+	int32 BitsPerBlock = 1;
+	uint32 IndexMask = 1;
+	// 32 / BitsPerBlock entries per word, as a shift and mask
+	int32 EntriesPerWordShift = 5;
+	int32 EntriesPerWordMask = 31;
+};
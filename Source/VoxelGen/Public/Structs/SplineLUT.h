@@ -0,0 +1,37 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class UCurveFloat;
+
+// Fixed-resolution lookup table baked from a curve asset.
+// Plain data, so worker threads can sample it without touching the UObject.
+struct VOXELGEN_API FSplineLUT
+{
+public:
+	// Samples the curve at Resolution evenly spaced points covering [0, 1] and the curve's key range
+	void Bake(const UCurveFloat* Curve, int32 Resolution);
+	void Reset();
+
+	// Largest absolute difference between the table and the curve over NumTestSamples points
+	float MeasureMaxError(const UCurveFloat* Curve, int32 NumTestSamples) const;
+
+	bool IsBaked() const { return Samples.Num() > 1; }
+	int32 GetResolution() const { return Samples.Num(); }
+
+	// Linear interpolation between the two nearest samples, clamped to the baked range
+	FORCEINLINE float Evaluate(float InValue) const
+	{
+		const float Position = (FMath::Clamp(InValue, MinTime, MaxTime) - MinTime) * InvStep;
+		const int32 Index = FMath::Min(FMath::FloorToInt32(Position), Samples.Num() - 2);
+		return FMath::Lerp(Samples[Index], Samples[Index + 1], Position - Index);
+	}
+
+private:
+	TArray<float> Samples;
+	float MinTime = 0.f;
+	float MaxTime = 1.f;
+	float InvStep = 0.f;
+};
@@ -0,0 +1,48 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "VoxelGen/Enums.h"
+
+struct FChunkVoxels;
+
+// The column a structure grows from: its biome, its top solid block and the block a structure would start in
+struct FStructureSite
+{
+	EBiomeType Biome{};
+	int32 TopSolidZ = -1;
+	EBlock SurfaceBlock = EBlock::Air;
+	EBlock SpawnBlock = EBlock::Air;
+};
+
+// Writes structures (trees, cacti) into one chunk's voxels, filling air only. Blocks past the chunk's sides are
+// dropped: every chunk also places the structures rooted just outside it, from their probed sites, and keeps
+// the part that reaches in, so a tree comes out whole whichever side of a border it grows from.
+struct VOXELGEN_API FStructureWriter
+{
+public:
+	explicit FStructureWriter(FChunkVoxels& InVoxels);
+
+	void SetBlock(int32 LocalX, int32 LocalY, int32 LocalZ, EBlock Block);
+
+	// Fills heights [StartZ, EndZ) of one column, clipped to the world; a column in this chunk is looked up once
+	void SetSpan(int32 LocalX, int32 LocalY, int32 StartZ, int32 EndZ, EBlock Block);
+
+	bool IsInsideChunk(int32 LocalX, int32 LocalY) const { return LocalX >= 0 && LocalX < ChunkSize && LocalY >= 0 && LocalY < ChunkSize; }
+
+	// Block in this chunk, Air for positions outside it
+	EBlock GetBlock(int32 LocalX, int32 LocalY, int32 LocalZ) const;
+
+	// Site of a column in this chunk as its voxels are now
+	FStructureSite GetSite(int32 LocalX, int32 LocalY) const;
+
+	FChunkVoxels& GetVoxels() const { return Voxels; }
+	int32 GetChunkSize() const { return ChunkSize; }
+	int32 GetChunkHeight() const { return ChunkHeight; }
+
+private:
+	FChunkVoxels& Voxels;
+	int32 ChunkSize;
+	int32 ChunkHeight;
+};
@@ -126,6 +126,102 @@ struct FCategorizedBiomeInputs
 	FCategorizedBiomeInputs() = default;
 };
 
+// Height range carved by the cave noise wherever it rises above Threshold
+USTRUCT()
+struct FCaveLayer
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, Category = "Settings", meta = (ClampMin = "0"))
+	int32 MinHeight = 8;
+	UPROPERTY(EditAnywhere, Category = "Settings", meta = (ClampMin = "0"))
+	int32 MaxHeight = 40;
+	// Higher is rarer, narrower caves
+	UPROPERTY(EditAnywhere, Category = "Settings", meta = (ClampMin = "-1.0", ClampMax = "1.0"))
+	float Threshold = 0.5f;
+};
+
+// Surface height, biome and climate of one column, without any voxel data
+USTRUCT(BlueprintType)
+struct FTerrainSurfaceSample
+{
+	GENERATED_BODY()
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Terrain Surface")
+	int32 Height = 0;
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Terrain Surface")
+	EBiomeType Biome = EBiomeType::Desert;
+
+	// Splined terrain parameters and clamped climate, all in [0, 1]
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Terrain Surface")
+	float Continentalness = 0.f;
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Terrain Surface")
+	float Erosion = 0.f;
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Terrain Surface")
+	float Weirdness = 0.f;
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Terrain Surface")
+	float PeaksValleys = 0.f;
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Terrain Surface")
+	float Temperature = 0.f;
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Terrain Surface")
+	float Humidity = 0.f;
+};
+
+// Structure-of-arrays buffers for a rectangular region of columns.
+// Each generation stage rewrites the arrays in place: raw noise -> [0, 1] -> splined values.
+struct FTerrainFieldBuffer
+{
+	int32 OriginX = 0;
+	int32 OriginY = 0;
+	int32 SizeX = 0;
+	int32 SizeY = 0;
+
+	TArray<float> Continentalness;
+	TArray<float> Erosion;
+	TArray<float> Weirdness;
+	TArray<float> PeaksValleys;
+	TArray<float> Temperature;
+	TArray<float> Humidity;
+
+	TArray<int32> Height;
+	TArray<EBiomeType> Biome;
+
+	void Initialize(int32 InOriginX, int32 InOriginY, int32 InSizeX, int32 InSizeY)
+	{
+		OriginX = InOriginX;
+		OriginY = InOriginY;
+		SizeX = InSizeX;
+		SizeY = InSizeY;
+
+		const int32 Count = Num();
+		Continentalness.SetNumUninitialized(Count);
+		Erosion.SetNumUninitialized(Count);
+		Weirdness.SetNumUninitialized(Count);
+		PeaksValleys.SetNumUninitialized(Count);
+		Temperature.SetNumUninitialized(Count);
+		Humidity.SetNumUninitialized(Count);
+		Height.SetNumUninitialized(Count);
+		Biome.SetNumUninitialized(Count);
+	}
+
+	int32 Num() const { return SizeX * SizeY; }
+	int32 GetIndex(int32 LocalX, int32 LocalY) const { return LocalX + LocalY * SizeX; }
+
+	FTerrainSurfaceSample GetSample(int32 Index) const
+	{
+		FTerrainSurfaceSample Sample;
+		Sample.Height = Height[Index];
+		Sample.Biome = Biome[Index];
+		Sample.Continentalness = Continentalness[Index];
+		Sample.Erosion = Erosion[Index];
+		Sample.Weirdness = Weirdness[Index];
+		Sample.PeaksValleys = PeaksValleys[Index];
+		Sample.Temperature = Temperature[Index];
+		Sample.Humidity = Humidity[Index];
+		return Sample;
+	}
+};
+
 
 template<typename T>
 struct FMapData
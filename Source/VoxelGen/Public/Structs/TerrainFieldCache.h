@@ -0,0 +1,60 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TerrainData.h"
+#include <atomic>
+
+// One TileSize x TileSize block of generated 2D fields
+struct FTerrainFieldTile
+{
+	FIntVector2 TileCoordinates;
+	FTerrainFieldBuffer Fields;
+};
+
+// Region-level cache of the 2D climate/height fields, shared by every reader that needs per-column values.
+// Tiles are immutable once published, so readers only hold the lock long enough to grab a reference.
+class VOXELGEN_API FTerrainFieldCache
+{
+public:
+	static constexpr int32 TileSize = 64;
+
+	using FTileRef = TSharedPtr<const FTerrainFieldTile, ESPMode::ThreadSafe>;
+	using FGenerateFields = TFunctionRef<void(FTerrainFieldBuffer&)>;
+
+	// Maximum number of tiles kept before the least recently used ones are dropped
+	void SetCapacity(int32 InMaxTiles);
+	int32 GetCapacity() const { return MaxTiles; }
+	int32 Num() const;
+
+	// Drops every tile; tiles still being generated for the old settings are discarded when they finish
+	void Invalidate();
+
+	// Returns the tile, generating it with GenerateFields on a miss
+	FTileRef GetTile(const FIntVector2& TileCoordinates, FGenerateFields GenerateFields);
+
+	static FIntVector2 GetTileCoordinates(int32 GlobalX, int32 GlobalY)
+	{
+		return FIntVector2(
+			FMath::FloorToInt(static_cast<float>(GlobalX) / TileSize),
+			FMath::FloorToInt(static_cast<float>(GlobalY) / TileSize));
+	}
+
+private:
+	struct FEntry
+	{
+		FTileRef Tile;
+		std::atomic<uint64> LastUsed { 0 };
+	};
+
+	void Touch(FEntry& Entry);
+	void EvictLeastRecentlyUsed();
+
+	mutable FRWLock Lock;
+	TMap<FIntVector2, TUniquePtr<FEntry>> Tiles;
+	int32 MaxTiles = 64;
+
+	std::atomic<uint64> UseCounter { 0 };
+	std::atomic<uint32> Epoch { 0 };
+};
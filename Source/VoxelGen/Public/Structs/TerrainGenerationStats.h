@@ -0,0 +1,56 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include <atomic>
+
+// Cycles spent in each generation stage, summed over every thread that generated.
+// Always collected; the counters are touched once per stage per region, not per column.
+struct VOXELGEN_API FTerrainGenerationStats
+{
+	std::atomic<uint64> NoiseCycles { 0 };
+	std::atomic<uint64> SplineCycles { 0 };
+	std::atomic<uint64> HeightCycles { 0 };
+	std::atomic<uint64> ClassificationCycles { 0 };
+	std::atomic<uint64> BlendCycles { 0 };
+	std::atomic<uint64> PopulateCycles { 0 };
+	std::atomic<uint64> FoliageCycles { 0 };
+	std::atomic<uint64> DensityCycles { 0 };
+
+	// Columns run through the 2D field stages, cache misses only
+	std::atomic<uint64> FieldColumnsGenerated { 0 };
+	std::atomic<uint64> ChunksGenerated { 0 };
+	// Voxels the 3D density stage interpolated and tested, surface band plus cave layers
+	std::atomic<uint64> DensityVoxelsEvaluated { 0 };
+	std::atomic<uint64> DensityNodesSampled { 0 };
+	// Columns whose foliage rules were rolled, every eligible column per chunk or only grid candidates
+	std::atomic<uint64> FoliageSitesEvaluated { 0 };
+	// Vertical sections of the generated chunks by flag; meshing skips the empty ones and most of the uniform ones
+	std::atomic<uint64> SectionsEmpty { 0 };
+	std::atomic<uint64> SectionsUniform { 0 };
+	std::atomic<uint64> SectionsMixed { 0 };
+
+	void Reset();
+
+	static double ToSeconds(const std::atomic<uint64>& Cycles) { return FPlatformTime::ToSeconds64(Cycles.load(std::memory_order_relaxed)); }
+};
+
+// Adds the cycles spent in its scope to one stage counter
+class FScopedGenerationStageTimer
+{
+public:
+	explicit FScopedGenerationStageTimer(std::atomic<uint64>& InCounter)
+		: Counter(InCounter), StartCycles(FPlatformTime::Cycles64())
+	{
+	}
+
+	~FScopedGenerationStageTimer()
+	{
+		Counter.fetch_add(FPlatformTime::Cycles64() - StartCycles, std::memory_order_relaxed);
+	}
+
+private:
+	std::atomic<uint64>& Counter;
+	uint64 StartCycles;
+};
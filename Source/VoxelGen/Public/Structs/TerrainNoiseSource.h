@@ -0,0 +1,38 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "FastNoise/FastNoise.h"
+
+class UNoiseOctaveSettingsAsset;
+struct FTerrainFieldBuffer;
+
+// One noise field: a plain FastNoise instance configured from a UNoiseOctaveSettingsAsset.
+// Sampling is const and touches no UObject, so worker threads can share one source.
+struct VOXELGEN_API FTerrainNoiseSource
+{
+public:
+	// Configures the noise for Settings at WorldSeed + SeedOffset; a null asset leaves the source flat at 0
+	void Setup(const UNoiseOctaveSettingsAsset* Settings, int32 WorldSeed, int32 InSampleStep);
+
+	bool IsValid() const { return bIsValid; }
+	int32 GetSampleStep() const { return SampleStep; }
+
+	FORCEINLINE float GetNoise2D(float X, float Y) const { return Noise.GetNoise(X, Y); }
+	FORCEINLINE float GetNoise3D(float X, float Y, float Z) const { return Noise.GetNoise(X, Y, Z); }
+
+	// Writes raw [-1, 1] noise for every column of the region, on the coarse lattice when the step is above 1
+	void SampleRegion(const FTerrainFieldBuffer& Fields, TArray<float>& OutValues) const;
+
+	// Interpolation error of the coarse lattice against full resolution over the region, in raw noise units
+	void MeasureCoarseError(const FTerrainFieldBuffer& Fields, float& OutMaxError, float& OutMeanError) const;
+
+private:
+	void SampleFull(const FTerrainFieldBuffer& Fields, TArray<float>& OutValues) const;
+	void SampleCoarse(const FTerrainFieldBuffer& Fields, TArray<float>& OutValues) const;
+
+	FastNoise Noise;
+	int32 SampleStep = 1;
+	bool bIsValid = false;
+};